@@ -4,2241 +4,343 @@
  */
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <getopt.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <locale.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 #include <wchar.h>
 
-#define F(fmt) __FILE__":%d:%s: " fmt, __LINE__, __func__
+#include "banner.h"
+#include "repaint.h"
 
 #ifndef UTF
 #define UTF 0
 #endif
 
-#define MIN(a, b) ((a) < (b) ? (a) : (b))
-#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define SCALE_MAX   1000    /* for -s */
+#define HZ_MAX      1000    /* for --coalesce */
+#define LINE_PART   (64 * 1024) /* longest piece of a line kept */
 
-static void process(FILE *f);
-static size_t proc_line( wchar_t *line, size_t last_l);
-static void hor_line(size_t l, const char *lft, const char *rgt);
+static void process(struct sb_ctx *ctx, FILE *f);
+static void proc_line(struct sb_ctx *ctx, const char *line, size_t len);
+static void live(struct sb_ctx *ctx, int fd);
+static void coalesce(struct sb_ctx *ctx, int fd);
+static void check(ssize_t res, const char *what);
 
-struct chrinfo {
-    size_t w, h;
-    char **s;
-};
-
-struct range {
-    wchar_t fst;
-    wchar_t lst;
-    struct chrinfo *ci;
-};
-
-static struct chrinfo *getchrinfo(wchar_t c);
-
-static char *c_unknown[] = {
-    "  ????",
-    " ?    ?",
-    "?      ?",
-    "?      ?",
-    "????????",
-    "  ?  ?",
-    "???  ???",
-    0
-};
-
-static char *c_space[] = {
-    0
-};
-
-static char *c_exclam[] = {
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "",
-    "#",
-    0
-};
-
-static char *c_dquot[] = {
-    "## ##",
-    "## ##",
-    " #  #",
-    "#  #",
-    0
-};
-
-static char *c_hash[] = {
-    ""
-    ""
-    "  # #",
-    "  # #",
-    "#######",
-    "  # #",
-    "#######",
-    "  # #",
-    "  # #",
-    0
-};
-
-static char *c_dollar[] = {
-    ""
-    ""
-    "  # #",
-    " ######",
-    "# # #",
-    " #####",
-    "  # # #",
-    "######",
-    "  # #",
-    0
-};
-
-static char *c_percent[] = {
-    "       #",
-    " ##   #",
-    " ##  #",
-    "    #",
-    "   #",
-    "  #  ##",
-    " #   ##",
-    "#",
-    0
-};
-
-static char *c_ampers[] = {
-    "  #",
-    " # #",
-    "  #",
-    "  ##",
-    " #  # #",
-    "#    #",
-    " #### #",
-    0
-};
-
-static char *c_quote[] = {
-    "##",
-    "##",
-    " #",
-    "#",
-    0
-};
-
-static char *c_lparen[] = {
-    "  #",
-    " #",
-    "#",
-    "#",
-    "#",
-    "#",
-    " #",
-    "  #",
-    0
-};
-
-static char *c_rparen[] = {
-    "#",
-    " #",
-    "  #",
-    "  #",
-    "  #",
-    "  #",
-    " #",
-    "#",
-    0
-};
-
-static char *c_asterisk[] = {
-    "",
-    "",
-    " #   #",
-    "  # #",
-    "#######",
-    "  # #",
-    " #   #",
-    0
-};
-
-static char *c_plus[] = {
-    "",
-    "",
-    "   #",
-    "   #",
-    "#######",
-    "   # ",
-    "   #",
-    0
-};
-
-static char *c_comma[] = {
-    "",
-    "",
-    "",
-    "",
-    "",
-    "##",
-    "##",
-    " #",
-    "#",
-    0
-};
-
-static char *c_minus[] = {
-    "",
-    "",
-    "",
-    "",
-    "#######",
-    0
-};
-
-static char *c_dot[] = {
-    "",
-    "",
-    "",
-    "",
-    "",
-    "##",
-    "##",
-    0
-};
-
-static char *c_slash[] = {
-    "       #",
-    "      #",
-    "     #",
-    "    #",
-    "   #",
-    "  #",
-    " #",
-    "#",
-    0
-};
-
-static char *c_0[] = {
-#if 1
-    "  ###",
-    " #   #",
-    "#  #  #",
-    "# ### #",
-    "#  #  #",
-    " #   #",
-    "  ###",
-#else
-    "  ###",
-    " #   #",
-    "#   # #",
-    "#  #  #",
-    "# #   #",
-    " #   #",
-    "  ###",
-#endif
-    0
-};
-
-static char *c_1[] = {
-    "   #   ",
-    "  ##",
-    " # #",
-    "   #",
-    "   #",
-    "   #",
-    " ####",
-    0
-};
-
-static char *c_2[] = {
-    " ####",
-    "##   ##",
-    "     ##",
-    "    ##",
-    "  ##",
-    " #",
-    "#######",
-    0
-};
-
-static char *c_3[] = {
-    " #####",
-    " #   #",
-    "    #",
-    "   ##",
-    "     ##",
-    "##   ##",
-    "  ### ",
-    0
-};
-
-static char *c_4[] = {
-    "    #",
-    "   ##",
-    "  # #",
-    " #  #",
-    "#######",
-    "    #",
-    "   ###",
-    0
-};
-
-static char *c_5[] = {
-    "######",
-    "#",
-    "##",
-    "  ###",
-    "     ##",
-    "##   ##",
-    "  ###",
-    0
-};
-
-static char *c_6[] = {
-    "    ##",
-    "  ##",
-    " #",
-    "# ###",
-    "##   ##",
-    "##   ##",
-    "  ###",
-    0
-};
-
-static char *c_7[] = {
-    "#######",
-    "#     #",
-    "     #",
-    "    #",
-    "   #",
-    "  ##",
-    "  ##",
-    0
-};
-
-static char *c_8[] = {
-    "  ###",
-    "##   ##",
-    "##   ##",
-    "  ###",
-    "##   ##",
-    "##   ##",
-    "  ###",
-    0
-};
-
-static char *c_9[] = {
-    "  ###",
-    "##   ##",
-    "##   ##",
-    " #####",
-    "    #",
-    "  ##",
-    " ##",
-    0
-};
-
-static char *c_colon[] = {
-    "",
-    "",
-    "##",
-    "##",
-    "",
-    "##",
-    "##",
-    0
-};
-
-static char *c_semicolon[] = {
-    "",
-    "",
-    "##",
-    "##",
-    "",
-    "##",
-    "##",
-    " #",
-    "#",
-    0
-};
-
-static char *c_less[] = {
-    "    #",
-    "   #",
-    "  #",
-    " #",
-    "#",
-    " #",
-    "  #",
-    "   #",
-    "    #",
-    0
-};
-
-static char *c_eq[] = {
-    "",
-    "",
-    "",
-    "#######",
-    "",
-    "#######",
-    0
-};
-
-static char *c_greater[] = {
-    "#",
-    " #",
-    "  #",
-    "   #",
-    "    #",
-    "   #",
-    "  #",
-    " #",
-    "#",
-    0
-};
-
-static char *c_qmark[] = {
-    " #####",
-    "#     #",
-    "      #",
-    "    ##",
-    "   #",
-    "",
-    "   #",
-    0
-};
-
-static char *c_atsign[] = {
-    " #####",
-    "#     #",
-    "#  ####",
-    "# #   #",
-    "# #####",
-    "#",
-    " ######",
-    0
-};
-
-static char *c_A[] = {
-    "   #",
-    "  # #",
-    " #   #",
-    "#     #",
-    "#######",
-    "#     #",
-    "#     #",
-    0
-};
-
-static char *c_B[] = {
-    "######",
-    "#     #",
-    "#     #",
-    "######",
-    "#     #",
-    "#     #",
-    "######",
-    0
-};
-
-static char *c_C[] = {
-    " #####",
-    "#     #",
-    "#",
-    "#",
-    "#",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_D[] = {
-    "#####",
-    "#    #",
-    "#     #",
-    "#     #",
-    "#     #",
-    "#    #",
-    "#####",
-    0
-};
-
-static char *c_E[] = {
-    "#######",
-    "#",
-    "#",
-    "#####",
-    "#",
-    "#",
-    "#######",
-    0
-};
-
-static char *c_F[] = {
-    "#######",
-    "#",
-    "#",
-    "#####",
-    "#",
-    "#",
-    "#",
-    0
-};
-
-static char *c_G[] = {
-    " ######",
-    "#      #",
-    "#",
-    "#   ####",
-    "#      #",
-    "#      #",
-    " ######",
-    0
-};
-
-static char *c_H[] = {
-    "#      #",
-    "#      #",
-    "#      #",
-    "########",
-    "#      #",
-    "#      #",
-    "#      #",
-    0
-};
-
-static char *c_I[] = {
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    0
-};
-
-static char *c_J[] = {
-    "      #",
-    "      #",
-    "      #",
-    "      #",
-    "      #",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_K[] = {
-    "#    #",
-    "#   #",
-    "#  #",
-    "###",
-    "#  #",
-    "#   #",
-    "#    #",
-    0
-};
-
-static char *c_L[] = {
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#######",
-    0
-};
-
-static char *c_M[] = {
-    "#     #",
-    "##   ##",
-    "# # # #",
-    "#  #  #",
-    "#     #",
-    "#     #",
-    "#     #",
-    0
-};
-
-static char *c_N[] = {
-    "#     #",
-    "##    #",
-    "# #   #",
-    "#  #  #",
-    "#   # #",
-    "#    ##",
-    "#     #",
-    0
-};
-
-static char *c_O[] = {
-    " ####",
-    "#    #",
-    "#    #",
-    "#    #",
-    "#    #",
-    "#    #",
-    " ####",
-    0
-};
-
-static char *c_P[] = {
-    "#####",
-    "#    #",
-    "#    #",
-    "#####",
-    "#",
-    "#",
-    "#",
-    0
-};
-
-static char *c_Q[] = {
-    " ####",
-    "#    #",
-    "#    #",
-    "#    #",
-    "#  # #",
-    "#   #",
-    " ### #",
-    0
-};
-
-static char *c_R[] = {
-    "#####",
-    "#    #",
-    "#    #",
-    "#####",
-    "#  #",
-    "#   #",
-    "#    #",
-    0
-};
-
-static char *c_S[] = {
-    " ####",
-    "#    #",
-    "#",
-    " ####",
-    "     #",
-    "#    #",
-    " ####",
-    0
-};
-
-static char *c_T[] = {
-    "#######",
-    "   #",
-    "   #",
-    "   #",
-    "   #",
-    "   #",
-    "   #",
-    0
-};
-
-static char *c_U[] = {
-    "#    #",
-    "#    #",
-    "#    #",
-    "#    #",
-    "#    #",
-    "#    #",
-    " ####",
-    0
-};
-
-static char *c_V[] = {
-    "#     #",
-    "#     #",
-    "#     #",
-    "#     #",
-    " #   #",
-    "  # #",
-    "   #",
-    0
-};
-
-static char *c_W[] = {
-    "#     #",
-    "#     #",
-    "#     #",
-    "#  #  #",
-    "# # # #",
-    "##   ##",
-    "#     #",
-    0
-};
-
-static char *c_X[] = {
-    "#     #",
-    " #   #",
-    "  # #",
-    "   #",
-    "  # #",
-    " #   #",
-    "#     #",
-    0
-};
-
-static char *c_Y[] = {
-    "#     #",
-    " #   #",
-    "  # #",
-    "   #",
-    "   #",
-    "   #",
-    "   #",
-    0
-};
-
-static char *c_Z[] = {
-    "#######",
-    "     #",
-    "    #",
-    "   #",
-    "  #",
-    " #",
-    "#######",
-    0
-};
-
-static char *c_lbkt[] = {
-    "###",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "###",
-    0
-};
-
-static char *c_bslsh[] = {
-    "#",
-    " #",
-    "  #",
-    "   #",
-    "    #",
-    "     #",
-    "      #",
-    "       #",
-    0
-};
-
-static char *c_rbkt[] = {
-    "###",
-    "  #",
-    "  #",
-    "  #",
-    "  #",
-    "  #",
-    "  #",
-    "###",
-    0
-};
-
-static char *c_circunf[] = {
-    "",
-    "  #",
-    " # #",
-    "#   #",
-    0
-};
-
-
-static char *c_undscore[] = {
-    "",
-    "",
-    "",
-    "",
-    "",
-    "",
-    "#######",
-    0
-};
-
-static char *c_lquot[] = {
-    "##",
-    "##",
-    "#",
-    " #",
-    0
-};
-
-static char *c_a[] = {
-    "",
-    "",
-    " ####",
-    "     #",
-    " #####",
-    "#    #",
-    " #### #",
-    0
-};
-
-static char *c_b[] = {
-    "#",
-    "#",
-    "#####",
-    "#    #",
-    "#    #",
-    "#    #",
-    "#####",
-    0
-};
-
-static char *c_c[] = {
-    "",
-    "",
-    " ####",
-    "#    #",
-    "#",
-    "#",
-    " ####",
-    0
-};
-
-static char *c_d[] = {
-    "     #",
-    "     #",
-    " #####",
-    "#    #",
-    "#    #",
-    "#    #",
-    " ######",
-    0
-};
-
-static char *c_e[] = {
-    "",
-    "",
-    " ####",
-    "#    #",
-    "#####",
-    "#",
-    " #####",
-    0
-};
-
-static char *c_f[] = {
-    "  ##",
-    " #",
-    "####",
-    " #",
-    " #",
-    " #",
-    " #",
-    0
-};
-
-static char *c_g[] = {
-    "",
-    "",
-    " ####",
-    "#    #",
-    "#    #",
-    "#    #",
-    " #####",
-    "      #",
-    " #####",
-    0
-};
-
-static char *c_h[] = {
-    "#",
-    "#",
-    "#####",
-    "#    #",
-    "#    #",
-    "#    #",
-    "#    #",
-    0
-};
-
-static char *c_i[] = {
-    "#",
-    "",
-    "#",
-    "#",
-    "#",
-    "#",
-    " ##",
-    0
-};
-
-static char *c_j[] = {
-    "  #",
-    "",
-    "  #",
-    "  #",
-    "  #",
-    "  #",
-    "  #",
-    "  #",
-    "##",
-    0
-};
-
-static char *c_k[] = {
-    "#",
-    "#   #",
-    "#  #",
-    "#####",
-    "#    #",
-    "#    #",
-    "#    #",
-    0
-};
-
-static char *c_l[] = {
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    " ##",
-    0
-};
-
-static char *c_m[] = {
-    "",
-    "",
-    "### ##",
-    "#  #  #",
-    "#  #  #",
-    "#  #  #",
-    "#  #  #",
-    0
-};
-
-static char *c_n[] = {
-    "",
-    "",
-    "# ###",
-    "##   #",
-    "#    #",
-    "#    #",
-    "#    #",
-    0
-};
-
-static char *c_o[] = {
-    "",
-    "",
-    " ####",
-    "#    #",
-    "#    #",
-    "#    #",
-    " ####",
-    0
-};
-
-static char *c_p[] = {
-    "",
-    "",
-    "#####",
-    "#    #",
-    "#    #",
-    "#    #",
-    "#####",
-    "#",
-    "#",
-    0
-};
-
-static char *c_q[] = {
-    "",
-    "",
-    " #####",
-    "#    #",
-    "#    #",
-    "#    #",
-    " #####",
-    "     #",
-    "     #",
-    0
-};
-
-static char *c_r[] = {
-    "",
-    "",
-    "# ### ",
-    "##  ##",
-    "#",
-    "#",
-    "#",
-    0
-};
-
-static char *c_s[] = {
-    "",
-    "",
-    " #####",
-    "#",
-    " ####",
-    "     #",
-    "#####",
-    0
-};
-
-static char *c_t[] = {
-    "  #",
-    "  #",
-    "######",
-    "  #",
-    "  #",
-    "  #",
-    "   ###",
-    0
-};
-
-static char *c_u[] = {
-    "",
-    "",
-    "#    #",
-    "#    #",
-    "#    #",
-    "#    #",
-    " #### #",
-    0
-};
-
-static char *c_v[] = {
-    "",
-    "",
-    "#     #",
-    "#     #",
-    " #   #",
-    "  # #",
-    "   #",
-    0
-};
-
-static char *c_w[] = {
-    "",
-    "",
-    "#     #",
-    "#     #",
-    "#  #  #",
-    "#  #  #",
-    " ## ##",
-    0
-};
-
-static char *c_x[] = {
-    "",
-    "",
-    "#   #",
-    " # #",
-    "  #",
-    " # #",
-    "#   #",
-    0
-};
-
-static char *c_y[] = {
-    "",
-    "",
-    "#    #",
-    "#    #",
-    "#    #",
-    "#    #",
-    " #####",
-    "     #",
-    " ####",
-    0
-};
-
-static char *c_z[] = {
-    "",
-    "",
-    "#####",
-    "   #",
-    "  #",
-    " #",
-    "#####",
-    0
-};
-
-static char *c_lcbkt[] = {
-    "  ##",
-    " #",
-    " #",
-    " #",
-    "#",
-    " #",
-    " #",
-    " #",
-    "  ##",
-    0
-};
-
-static char *c_vbar[] = {
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    0
-};
-
-static char *c_rcbkt[] = {
-    "##",
-    "  #",
-    "  #",
-    "  #",
-    "   #",
-    "  #",
-    "  #",
-    "  #",
-    "##",
-    0
-};
-
-static char *c_tilde[] = {
-    " ##  #",
-    "#  ##",
-    0
-};
-
-static char *c_iexclam[] = {
-    "#",
-    "",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    "#",
-    0
-};
-
-static char *c_cent[] = {
-    "",
-    "   #",
-    " #####",
-    "#  #  #",
-    "#  #",
-    "#  #",
-    " #####",
-    "   #",
-    0
-};
-
-static char *c_pound[] = {
-    "  ###",
-    " #   #",
-    " #",
-    "####",
-    " #",
-    " #    #",
-    "######",
-    0,
-};
-
-static char *c_currency[] = {
-    "# ### #",
-    " #   #",
-    "#     #",
-    "#     #",
-    "#     #",
-    " #   #",
-    "# ### #",
-    0
-};
-
-static char *c_yen[] = {
-    "#     #",
-    " #   #",
-    "#######",
-    "   #",
-    "#######",
-    "   #",
-    "   #",
-    0
-};
-
-static char *c_bbar[] = {
-    "#",
-    "#",
-    "#",
-    "#",
-    "",
-    "#",
-    "#",
-    "#",
-    "#",
-    0
-};
-
-static char *c_section[] = {
-    " #####",
-    "#",
-    "# ###",
-    " #   #",
-    "  ### #",
-    "      #",
-    " #####",
-    0
-};
-
-static char *c_diaeresis[] = {
-    "##  ##",
-    "##  ##",
-    0
-};
-
-static char *c_copyright[] = {
-    "  ###  ",
-    " #   #",
-    "#  ## #",
-    "# #   #",
-    "#  ## #",
-    " #   #",
-    "  ###  ",
-    0
-};
-
-static char *c_femord[] = {
-    " ####",
-    "#   #",
-    " ### #",
-    "",
-    "######",
-    0
-};
-
-static char *c_lpdaq[] = {
-    "",
-    "",
-    "  # #",
-    " # #",
-    "# #",
-    " # #",
-    "  # #",
-    0
-};
-
-static char *c_not[] = {
-    "",
-    "",
-    "",
-    "",
-    "#######",
-    "      #",
-    "      #",
-    0
-};
-
-static char *c_softhyp[] = {
-    "",
-    "",
-    "",
-    "#     #",
-    "#######",
-    "#     #",
-    0
-};
-
-
-static char *c_reg[] = {
-    "  ###  ",
-    " #   #",
-    "# ### #",
-    "# #  ##",
-    "# ### #",
-    " ## ##",
-    "  ###  ",
-    0
-};
-
-static char *c_macron[] = {
-    "#######",
-    0
-};
-
-static char *c_degree[] = {
-    " ###",
-    "#   #",
-    " ###",
-    0
-};
-
-static char *c_plusminus[] = {
-    "",
-    "   #",
-    "   #",
-    "#######",
-    "   #",
-    "   #",
-    "#######",
-    0
-};
-
-static char *c_sup2[] = {
-    " ####",
-    "#    #",
-    "   ##",
-    " ##",
-    "######",
-    0
-};
-
-static char *c_sup3[] = {
-    " ####",
-    "   #",
-    "  ##",
-    "#   #",
-    " ###",
-    0
-};
-
-static char *c_acute[] = {
-    "  ##",
-    " ##",
-    "#",
-    0
-};
-
-static char *c_micro[] = {
-    "",
-    "",
-    "#   #",
-    "#   #",
-    "#   #",
-    "#   #",
-    "#### #",
-    "#",
-    "#",
-    0
-};
-
-static char *c_pilcrow[] = {
-    " #######",
-    "##### #",
-    "##### #",
-    " ######",
-    "    # #",
-    "    # #",
-    "    # #",
-    0
-};
-
-static char *c_cdot[] = {
-    "",
-    "",
-    "",
-    "##",
-    "##",
-    0
-};
-
-static char *c_cedilla[] = {
-    "",
-    "",
-    "",
-    "",
-    "",
-    "",
-    "   #",
-    "   #",
-    "  #",
-    0
-};
-
-static char *c_sup1[] = {
-    "  #  ",
-    " ##",
-    "  #",
-    "  #",
-    " ###",
-    0
-};
-
-static char *c_mascord[] = {
-    " ###",
-    "#   #",
-    " ###",
-    "",
-    "#####",
-    0
-};
-
-static char *c_rpdaq[] = {
-    "",
-    "",
-    "# #",
-    " # #",
-    "  # #",
-    " # #",
-    "# #",
-    0
-};
-
-static char *c_1_4[] = {
-    " #    #",
-    "##   #",
-    " #  #",
-    " # # ##",
-    "### # #",
-    " # #####",
-    "#     #",
-    0
-};
-
-static char *c_1_2[] = {
-    " #    #",
-    "##   #",
-    " #  #",
-    " # # ##",
-    "### #  #",
-    " #    #",
-    "#   ####",
-    0
-};
-
-static char *c_3_4[] = {
-    "###   #",
-    " #   #",
-    "  # #",
-    "## # ##",
-    "  # # #",
-    " # #####",
-    "#     #",
-    0
-};
-
-static char *c_lqm[] = {
-    "",
-    "",
-    "   #",
-    "",
-    "   #",
-    " ##",
-    "#",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_Agrave[] = {
-    "  #",
-    "   #",
-    "",
-    "  ###",
-    "#     #",
-    "#######",
-    "#     #",
-    0
-};
-
-static char *c_Aacute[] = {
-    "    #",
-    "   #",
-    "",
-    "  ###",
-    "#     #",
-    "#######",
-    "#     #",
-    0
-};
-
-static char *c_Acirc[] = {
-    "   #",
-    "  # #",
-    "",
-    "  ###",
-    "#     #",
-    "#######",
-    "#     #",
-    0
-};
-
-static char *c_Atilde[] = {
-    "  #  #",
-    " # ##",
-    "",
-    "  ###",
-    "#     #",
-    "#######",
-    "#     #",
-    0
-};
-
-static char *c_Adiaer[] = {
-    " #   # ",
-    "",
-    "  ###",
-    "#     #",
-    "#     #",
-    "#######",
-    "#     #",
-    0
-};
-
-static char *c_Aring[] = {
-    "   #",
-    "  # #",
-    "   #",
-    "  ###",
-    "#     #",
-    "#######",
-    "#     #",
-    0
-};
-
-static char *c_AE[] = {
-    "   ######",
-    "  # #",
-    " #  #",
-    "#   ####",
-    "#####",
-    "#   #",
-    "#   #####",
-    0
-};
-
-static char *c_Ccedil[] = {
-    " #####",
-    "#     #",
-    "#",
-    "#",
-    "#",
-    "#     #",
-    " #####",
-    "   #",
-    "  #",
-    0
-};
-
-static char *c_Egrave[] = {
-    "  #",
-    "   #",
-    "#######",
-    "#",
-    "####",
-    "#",
-    "#######",
-    0
-};
-
-static char *c_Eacute[] = {
-    "    #",
-    "   #",
-    "#######",
-    "#",
-    "####",
-    "#",
-    "#######",
-    0
-};
-
-static char *c_Ecirc[] = {
-    "   #",
-    "  # #",
-    "#######",
-    "#",
-    "####",
-    "#",
-    "#######",
-    0
-};
-
-static char *c_Ediaer[] = {
-    " #   # ",
-    "",
-    "#######",
-    "#",
-    "####",
-    "#",
-    "#######",
-    0
-};
-
-static char *c_Igrave[] = {
-    "#",
-    " #",
-	"",
-    "###",
-    " #",
-    " #",
-    "###",
-    0
-};
-
-static char *c_Iacute[] = {
-    "  #",
-    " #",
-	"",
-    "###",
-    " #",
-    " #",
-    "###",
-    0
-};
-
-static char *c_Icirc[] = {
-    " #",
-    "# #",
-    "",
-    "###",
-    " #",
-    " #",
-    "###",
-    0
-};
-
-static char *c_Idiaer[] = {
-    "#   #",
-    "",
-    " ###",
-    "  #",
-    "  #",
-    "  #",
-    " ###",
-    0
-};
-
-static char *c_Eth[] = {
-    "#####",
-    " #   ##",
-    " #     #",
-    "####   #",
-    " #     #",
-    " #   ##",
-    "#####",
-    0
-};
-
-static char *c_Ntilde[] = {
-    "  #  #",
-    " # ##",
-    "",
-    "#     #",
-    "# #   #",
-    "#   # #",
-    "#     #",
-    0
-};
-
-static char *c_Ograve[] = {
-    "  #",
-    "   #",
-    " #####",
-    "#     #",
-    "#     #",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_Oacute[] = {
-    "    #",
-    "   #",
-    " #####",
-    "#     #",
-    "#     #",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_Ocirc[] = {
-    "   #",
-    "  # #",
-    " #####",
-    "#     #",
-    "#     #",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_Otilde[] = {
-    "  #  #",
-    " # ##",
-    " #####",
-    "#     #",
-    "#     #",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_Odiaer[] = {
-    " #   #",
-    "",
-    " #####",
-    "#     #",
-    "#     #",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_multSign[] = {
-    "",
-    "",
-    "#       #",
-    "  #   #",
-    "    #",
-    "  #   #",
-    "#       #",
-    0
-};
-
-static char *c_Ostroke[] = {
-    " #### #",
-    "#    # ",
-    "#   # #",
-    "#  #  #",
-    "# #   #",
-    " #    #",
-    "# ####",
-    0
-};
-
-static char *c_Ugrave[] = {
-    "  #",
-    "   #",
-    "#     #",
-    "#     #",
-    "#     #",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_Uacute[] = {
-    "    #",
-    "   #",
-    "#     #",
-    "#     #",
-    "#     #",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_Ucirc[] = {
-    "   #",
-    "  # #",
-    "#     #",
-    "#     #",
-    "#     #",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_Udiaer[] = {
-    " #   #",
-    "",
-    "#     #",
-    "#     #",
-    "#     #",
-    "#     #",
-    " #####",
-    0
-};
-
-static char *c_Yacute[] = {
-    "  #",
-    "   #",
-    "#     #",
-    "  # #",
-    "   #",
-    "   #",
-    0
-};
-
-static char *c_Thorn[] = {
-    "#",
-    "#",
-    "######",
-    "#     #",
-    "#     #",
-    "######",
-    "#",
-    "#",
-    0
-};
-
-static char *c_ssharp[] = {
-    "  ###",
-    " #   #",
-    "#    #",
-    "#####",
-    "#    #",
-    "#     #",
-    "#     #",
-    "######",
-    0
-};
-
-static char *c_agrave[] = {
-    "  #",
-    "   #",
-    " ####",
-    "     #",
-    " #####",
-    "#    #",
-    " #### #",
-    0
-};
-
-static char *c_aacute[] = {
-    "    #",
-    "   #",
-    " ####",
-    "     #",
-    " #####",
-    "#    #",
-    " #### #",
-    0
-};
-
-static char *c_acirc[] = {
-    "   #",
-    "  # #",
-    " ####",
-    "     #",
-    " #####",
-    "#    #",
-    " #### #",
-    0
-};
-
-static char *c_atilde[] = {
-    " ### #",
-    "#   #",
-    " ####",
-    "     #",
-    " #####",
-    "#    #",
-    " #### #",
-    0
-};
-
-static char *c_adiaer[] = {
-    " #   #",
-    "",
-    " ####",
-    "     #",
-    " #####",
-    "#    #",
-    " #### #",
-    0
-};
-
-static char *c_aring[] = {
-    "  ###",
-    "  # #",
-    " ####",
-    "     #",
-    " #####",
-    "#    #",
-    " #### #",
-    0
-};
-
-static char *c_ae[] = {
-    "",
-    "",
-    " ### ##",
-    "    #  #",
-    " ######",
-    "#   #",
-    " ### ##",
-    0
-};
-
-static char *c_ccedil[] = {
-    "",
-    "",
-    " ####",
-    "#    #",
-    "#",
-    "#",
-    " ####",
-    "  #",
-    " #",
-    0
-};
-
-static char *c_egrave[] = {
-    "  #",
-    "   #",
-    " ####",
-    "#    #",
-    "#####",
-    "#",
-    " #####",
-    0
-};
-
-static char *c_eacute[] = {
-    "    #",
-    "   #",
-    " ####",
-    "#    #",
-    "#####",
-    "#",
-    " #####",
-    0
-};
-
-static char *c_ecirc[] = {
-    "   #",
-    "  # #",
-    " ####",
-    "#    #",
-    "#####",
-    "#",
-    " #####",
-    0
-};
-
-static char *c_ediaer[] = {
-    " #  #",
-    "",
-    " ####",
-    "#    #",
-    "#####",
-    "#",
-    " #####",
-    0
-};
-
-static char *c_igrave[] = {
-    "#",
-    " #",
-    "",
-    " #",
-    " #",
-    " #",
-    "  ##",
-    0
-};
-
-static char *c_iacute[] = {
-    " #",
-    "#",
-    "",
-    "#",
-    "#",
-    "#",
-    " ##",
-    0
-};
-
-static char *c_icirc[] = {
-    " #",
-    "# #",
-    "",
-    " #",
-    " #",
-    " #",
-    "  ##",
-    0
-};
-
-static char *c_idiaer[] = {
-    "#   #",
-    "",
-    "  #",
-    "  #",
-    "  #",
-    "  #",
-    "   ##",
-    0
-};
-
-static char *c_eth[] = {
-    " #  #",
-    "  #",
-    "#  #",
-    " ####",
-    "#    #",
-    "#    #",
-    " ####",
-    0
-};
-
-static char *c_ntilde[] = {
-    "#  ##",
-    " ##  #",
-    "",
-    "# ###",
-    "##   #",
-    "#    #",
-    "#    #",
-    0
-};
-
-static char *c_ograve[] = {
-    "  #",
-    "   #",
-    " ####",
-    "#    #",
-    "#    #",
-    "#    #",
-    " ####",
-    0
-};
-
-static char *c_oacute[] = {
-    "    #",
-    "   #",
-    " ####",
-    "#    #",
-    "#    #",
-    "#    #",
-    " ####",
-    0
-};
-
-static char *c_ocirc[] = {
-    "   #",
-    "  # #",
-    " ####",
-    "#    #",
-    "#    #",
-    "#    #",
-    " ####",
-    0
-};
-
-static char *c_otilde[] = {
-    "#  ##",
-    " ##  #",
-    " ####",
-    "#    #",
-    "#    #",
-    "#    #",
-    " ####",
-    0
-};
-
-static char *c_odiaer[] = {
-    " #  #",
-    "",
-    " ####",
-    "#    #",
-    "#    #",
-    "#    #",
-    " ####",
-    0
-};
-
-static char *c_divsign[] = {
-    "",
-    "",
-    "   ##",
-    "",
-    "########",
-    "",
-    "   ##",
-    0
-};
-
-static char *c_ostroke[] = {
-    "",
-    "",
-    " #####",
-    "#    ##",
-    "#  #  #",
-    "##    #",
-    " #####",
-    0
-};
-
-static char *c_ugrave[] = {
-    "  #",
-    "   #",
-    "#   #",
-    "#   #",
-    "#   #",
-    "#   #",
-    " ### #",
-    0
-};
-
-static char *c_uacute[] = {
-    "   #",
-    "  #",
-    "#   #",
-    "#   #",
-    "#   #",
-    "#   #",
-    " ### #",
-    0
-};
-
-static char *c_ucirc[] = {
-    "  #",
-    " # #",
-    "#   #",
-    "#   #",
-    "#   #",
-    "#   #",
-    " ### #",
-    0
-};
-
-static char *c_udiaer[] = {
-    "#   #",
-    "",
-    "#   #",
-    "#   #",
-    "#   #",
-    "#   #",
-    " ### #",
-    0
-};
-
-static char *c_yacute[] = {
-    "   #",
-    "  #",
-    "#    #",
-    "#    #",
-    "#    #",
-    "#    #",
-    " #####",
-    "     #",
-    " ####",
-    0
-};
-
-static char *c_thorn[] = {
-    "",
-    "",
-    "#",
-    "#####",
-    "#    #",
-    "#    #",
-    "#####",
-    "#",
-    0
-};
-
-static char *c_ydiaer[] = {
-    "#    #",
-    "",
-    "",
-    "#    #",
-    "#    #",
-    "#    #",
-    " #####",
-    "     #",
-    " ####",
-    0
-};
-
-static struct chrinfo  ci_invalid[] = {
-    {0, 0, c_unknown,},
-};
+int flags = 0;
 
-static struct chrinfo  latin1_0[] = {
-    /* 0x20 */ {7,0,c_space},
-    /* 0x21 */ {0,0,c_exclam}, {0,0,c_dquot}, {0,0,c_hash},
-    /* 0x24 */ {0,0,c_dollar}, {0,0,c_percent}, {0,0,c_ampers},
-    /* 0x27 */ {0,0,c_quote}, {0,0,c_lparen}, {0,0,c_rparen},
-    /* 0x2a */ {0,0,c_asterisk}, {0,0,c_plus}, {0,0,c_comma},
-    /* 0x2d */ {0,0,c_minus}, {0,0,c_dot}, {0,0,c_slash},
-    /* 0x30 */ {0,0,c_0}, {0,0,c_1}, {0,0,c_2}, {0,0,c_3},
-    /* 0x34 */ {0,0,c_4}, {0,0,c_5}, {0,0,c_6}, {0,0,c_7},
-    /* 0x38 */ {0,0,c_8}, {0,0,c_9}, {0,0,c_colon},
-    /* 0x3b */ {0,0,c_semicolon}, {0,0,c_less}, {0,0,c_eq},
-    /* 0x3e */ {0,0,c_greater}, {0,0,c_qmark}, {0,0,c_atsign},
-    /* 0x41 */ {0,0,c_A}, {0,0,c_B}, {0,0,c_C}, {0,0,c_D},
-    /* 0x45 */ {0,0,c_E}, {0,0,c_F}, {0,0,c_G}, {0,0,c_H},
-    /* 0x49 */ {0,0,c_I}, {0,0,c_J}, {0,0,c_K}, {0,0,c_L},
-    /* 0x4d */ {0,0,c_M}, {0,0,c_N}, {0,0,c_O}, {0,0,c_P},
-    /* 0x51 */ {0,0,c_Q}, {0,0,c_R}, {0,0,c_S}, {0,0,c_T},
-    /* 0x55 */ {0,0,c_U}, {0,0,c_V}, {0,0,c_W}, {0,0,c_X},
-    /* 0x59 */ {0,0,c_Y}, {0,0,c_Z}, {0,0,c_lbkt},
-    /* 0x5c */ {0,0,c_bslsh}, {0,0,c_rbkt}, {0,0,c_circunf},
-    /* 0x5f */ {0,0,c_undscore}, {0,0,c_lquot}, {0,0,c_a},
-    /* 0x62 */ {0,0,c_b}, {0,0,c_c}, {0,0,c_d}, {0,0,c_e},
-    /* 0x66 */ {0,0,c_f}, {0,0,c_g}, {0,0,c_h}, {0,0,c_i},
-    /* 0x6a */ {0,0,c_j}, {0,0,c_k}, {0,0,c_l}, {0,0,c_m},
-    /* 0x6e */ {0,0,c_n}, {0,0,c_o}, {0,0,c_p}, {0,0,c_q},
-    /* 0x72 */ {0,0,c_r}, {0,0,c_s}, {0,0,c_t}, {0,0,c_u},
-    /* 0x76 */ {0,0,c_v}, {0,0,c_w}, {0,0,c_x}, {0,0,c_y},
-    /* 0x7a */ {0,0,c_z}, {0,0,c_lcbkt}, {0,0,c_vbar},
-    /* 0x7d */ {0,0,c_rcbkt}, {0,0,c_tilde},
-};
+struct sb_style style;
+int encoding = -1;      /* SB_ENC_*, -1 until known */
+size_t wrap_width;      /* 0 for no wrapping */
+volatile sig_atomic_t resized;
+
+static int wrap_auto = 1;           /* the width follows the terminal */
+static int scale_x = 1, scale_y = 1;    /* for -s */
+
+static int out_fd = 1;
+static struct rp_screen *screen;    /* for FLAG_REPAINT */
+static struct lru *cache;           /* for -c */
+static struct sb_font *font;        /* for -F, NULL for the built-in */
+static int coalesce_hz;             /* for --coalesce */
+
+/* options without a short form */
+enum {
+    OPT_SERVE = 256,
+    OPT_CLOCK,
+    OPT_FILL,
+    OPT_COLOR,
+    OPT_FRAME_COLOR,
+    OPT_ENCODING,
+    OPT_STATS,
+    OPT_WRITEV,
+    OPT_FOLLOW,
+    OPT_COALESCE,
+};
+
+static struct option long_opts[] = {
+    { "serve",          required_argument, NULL, OPT_SERVE },
+    { "clock",          required_argument, NULL, OPT_CLOCK },
+    { "fill",           required_argument, NULL, OPT_FILL },
+    { "color",          required_argument, NULL, OPT_COLOR },
+    { "frame-color",    required_argument, NULL, OPT_FRAME_COLOR },
+    { "encoding",       required_argument, NULL, OPT_ENCODING },
+    { "stats",          optional_argument, NULL, OPT_STATS },
+    { "writev",         no_argument,       NULL, OPT_WRITEV },
+    { "follow",         no_argument,       NULL, OPT_FOLLOW },
+    { "coalesce",       required_argument, NULL, OPT_COALESCE },
+    { NULL, 0, NULL, 0 },
+};
+
+/* color modes of --color, with their default colors */
+#define MAX_PALETTE 64
+
+static struct color_mode {
+    const char *name;
+    int         mode;
+    const char *colors;
+} color_modes[] = {
+    { "none",       SB_COLOR_NONE,      NULL },
+    { "run",        SB_COLOR_RUN,       "36" },
+    { "glyph",      SB_COLOR_GLYPH,     "31,32,33,34,35,36" },
+    { "gradient",   SB_COLOR_GRADIENT,  "38;5;196,38;5;202,38;5;208,"
+                                        "38;5;214,38;5;220,38;5;226,"
+                                        "38;5;154,38;5;118,38;5;82,"
+                                        "38;5;46,38;5;49,38;5;51,"
+                                        "38;5;45,38;5;39,38;5;33,"
+                                        "38;5;27,38;5;57,38;5;93,"
+                                        "38;5;129,38;5;165,38;5;201" },
+    { NULL,         0,                  NULL },
+};
+
+/* parses the argument of --color, MODE[:SGR,SGR,...] */
+static int
+parse_color(
+        const char *arg)
+{
+    static const char *palette[MAX_PALETTE];
+    const char *colon = strchr(arg, ':');
+    size_t n = colon ? colon - arg : strlen(arg);
+    struct color_mode *m;
+    char *colors, *p;
+
+    for (m = color_modes; m->name; m++)
+        if (strlen(m->name) == n && !strncmp(arg, m->name, n))
+            break;
+    if (!m->name)
+        return -1;
+    style.color = m->mode;
+    style.ink = NULL;
+    style.palette = NULL;
+    style.npalette = 0;
+    if (m->mode == SB_COLOR_NONE)
+        return 0;
+
+    colors = strdup(colon && colon[1] ? colon + 1 : m->colors);
+    if (!colors) return -1;
+    for (p = strtok(colors, ","); p && style.npalette < MAX_PALETTE;
+            p = strtok(NULL, ","))
+        palette[style.npalette++] = p;
+    if (!style.npalette)
+        return -1;
+    style.ink = palette[0];
+    style.palette = palette;
+    return 0;
+} /* parse_color */
+
+/* true if some styling was asked for */
+int
+styled(void)
+{
+    return style.fill || style.color != SB_COLOR_NONE || style.frame;
+} /* styled */
+
+/* the encoding named s, ignoring case, '-' and '_' (so "UTF-8",
+ * "utf8" and "ISO_8859-1" are recognized) or -1 */
+static int
+enc_name(
+        const char *s,
+        size_t n)
+{
+    static const struct {
+        const char *name;
+        int         enc;
+    } names[] = {
+        { "utf8",       SB_ENC_UTF8 },
+        { "latin1",     SB_ENC_LATIN1 },
+        { "iso88591",   SB_ENC_LATIN1 },
+        { "locale",     SB_ENC_LOCALE },
+        { NULL,         -1 },
+    };
+    char buf[16];
+    size_t i, l = 0;
+
+    for (i = 0; i < n && l < sizeof buf - 1; i++)
+        if (s[i] != '-' && s[i] != '_')
+            buf[l++] = tolower((unsigned char) s[i]);
+    buf[l] = '\0';
+    for (i = 0; names[i].name; i++)
+        if (!strcmp(buf, names[i].name))
+            return names[i].enc;
+    return -1;
+} /* enc_name */
+
+/* the encoding of the input, guessed from the environment as
+ * setlocale(3) would, without loading the locale.  The C locale is
+ * taken as UTF-8, and only the locales with another codeset (or
+ * without one, like "en_US") need the locale's conversion. */
+static int
+env_encoding(void)
+{
+    static const char *vars[] = { "LC_ALL", "LC_CTYPE", "LANG", NULL };
+    const char *l = NULL, *dot;
+    int i, enc;
+
+    for (i = 0; vars[i] && !(l && *l); i++)
+        l = getenv(vars[i]);
+    if (!l || !*l || !strcmp(l, "C") || !strcmp(l, "POSIX"))
+        return SB_ENC_UTF8;
+    if ((dot = strchr(l, '.')) == NULL)
+        return SB_ENC_LOCALE;
+    dot++;
+    enc = enc_name(dot, strcspn(dot, "@"));
+    return enc < 0 ? SB_ENC_LOCALE : enc;
+} /* env_encoding */
+
+/* a new context with the options of the command line */
+struct sb_ctx *
+new_ctx(
+        int fl)
+{
+    struct sb_ctx *ctx = sb_new(fl);
 
-static struct chrinfo latin1_1[] = {
-    /* 0xA0 */ {7,0,c_space}, {0,0,c_iexclam}, {0,0,c_cent}, {0,0,c_pound},
-    /* 0xA4 */ {0,0,c_currency},{0,0,c_yen},{0,0,c_bbar},{0,0,c_section},
-    /* 0xA8 */ {0,0,c_diaeresis},{0,0,c_copyright},{0,0,c_femord},{0,0,c_lpdaq},
-    /* 0xAC */ {0,0,c_not},{7,0,c_softhyp},{0,0,c_reg},{0,0,c_macron},
-    /* 0xB0 */ {0,0,c_degree},{0,0,c_plusminus},{0,0,c_sup2},{0,0,c_sup3},
-    /* 0xB4 */ {0,0,c_acute},{0,0,c_micro},{0,0,c_pilcrow},{0,0,c_cdot},
-    /* 0xB8 */ {0,0,c_cedilla},{0,0,c_sup1},{0,0,c_mascord},{0,0,c_rpdaq},
-    /* 0xBC */ {0,0,c_1_4},{0,0,c_1_2},{0,0,c_3_4},{0,0,c_lqm},
-    /* 0xC0 */ {0,0,c_Agrave},{0,0,c_Aacute},{0,0,c_Acirc},{0,0,c_Atilde},
-    /* 0xC4 */ {0,0,c_Adiaer},{0,0,c_Aring},{0,0,c_AE},{0,0,c_Ccedil},
-    /* 0xC8 */ {0,0,c_Egrave},{0,0,c_Eacute},{0,0,c_Ecirc},{0,0,c_Ediaer},
-    /* 0xCC */ {0,0,c_Igrave},{0,0,c_Iacute},{0,0,c_Icirc},{0,0,c_Idiaer},
-    /* 0xD0 */ {0,0,c_Eth},{0,0,c_Ntilde},{0,0,c_Ograve},{0,0,c_Oacute},
-    /* 0xD4 */ {0,0,c_Ocirc},{0,0,c_Otilde},{0,0,c_Odiaer},{0,0,c_multSign},
-    /* 0xD8 */ {0,0,c_Ostroke},{0,0,c_Ugrave},{0,0,c_Uacute},{0,0,c_Ucirc},
-    /* 0xDC */ {0,0,c_Udiaer},{0,0,c_Yacute},{0,0,c_Thorn},{0,0,c_ssharp},
-    /* 0xE0 */ {0,0,c_agrave},{0,0,c_aacute},{0,0,c_acirc},{0,0,c_atilde},
-    /* 0xE4 */ {0,0,c_adiaer},{0,0,c_aring},{0,0,c_ae},{0,0,c_ccedil},
-    /* 0xE8 */ {0,0,c_egrave},{0,0,c_eacute},{0,0,c_ecirc},{0,0,c_ediaer},
-    /* 0xEC */ {0,0,c_igrave},{0,0,c_iacute},{0,0,c_icirc},{0,0,c_idiaer},
-    /* 0xF0 */ {0,0,c_eth},{0,0,c_ntilde},{0,0,c_ograve},{0,0,c_oacute},
-    /* 0xF4 */ {0,0,c_ocirc},{0,0,c_otilde},{0,0,c_odiaer},{0,0,c_divsign},
-    /* 0xF8 */ {0,0,c_ostroke},{0,0,c_ugrave},{0,0,c_uacute},{0,0,c_ucirc},
-    /* 0xFC */ {0,0,c_udiaer},{0,0,c_yacute},{0,0,c_thorn},{0,0,c_ydiaer},
-};
+    if (ctx && ((styled() && sb_set_style(ctx, &style) < 0)
+            || sb_set_encoding(ctx, encoding) < 0)) {
+        sb_free(ctx);
+        return NULL;
+    } /* if */
+    if (ctx) {
+        sb_set_width(ctx, wrap_width);
+        sb_set_scale(ctx, scale_x, scale_y);
+        sb_set_font(ctx, font);
+        if (stats_format != STATS_NONE)
+            stats_add(ctx);
+    } /* if */
+    return ctx;
+} /* new_ctx */
 
-static struct range ranges[] = {
-    { 0xfffe, 0xffff, ci_invalid },
-    { ' ', 0x7f, latin1_0 },
-    { 0xa0, 0xff, latin1_1 },
+void
+free_ctx(
+        struct sb_ctx *ctx)
+{
+    if (ctx && stats_format != STATS_NONE)
+        stats_drop(ctx);
+    sb_free(ctx);
+} /* free_ctx */
+
+/* the directories searched for the fonts given by name */
+static const char *font_dirs[] = {
+    "/usr/share/figlet",
+    "/usr/local/share/figlet",
+    NULL,
+};
+
+/* the directory of the compiled fonts, created if needed, or NULL
+ * if there's none (then the fonts are compiled each time) */
+static char *
+font_cache(void)
+{
+    const char *xdg = getenv("XDG_CACHE_HOME"), *home = getenv("HOME");
+    char *dir;
+    size_t n;
+
+    if (xdg && *xdg) {
+        n = strlen(xdg) + sizeof "/sysvbanner";
+        if ((dir = malloc(n)) != NULL) {
+            mkdir(xdg, 0755);
+            snprintf(dir, n, "%s/sysvbanner", xdg);
+        } /* if */
+    } else if (home && *home) {
+        n = strlen(home) + sizeof "/.cache/sysvbanner";
+        if ((dir = malloc(n)) != NULL) {
+            snprintf(dir, n, "%s/.cache", home);
+            mkdir(dir, 0755);
+            snprintf(dir, n, "%s/.cache/sysvbanner", home);
+        } /* if */
+    } else {
+        return NULL;
+    } /* if */
+    if (dir && mkdir(dir, 0755) < 0 && errno != EEXIST) {
+        free(dir);
+        return NULL;
+    } /* if */
+    return dir;
+} /* font_cache */
+
+/* loads the font name, a path if it has a slash, or else searched in
+ * $FIGLET_FONTDIR and the usual directories, with or without the
+ * .flf suffix */
+static struct sb_font *
+load_font(
+        const char *name)
+{
+    const char *env = getenv("FIGLET_FONTDIR");
+    char *cache = font_cache(), *path;
+    struct sb_font *f = NULL;
+    int i, sfx, err = ENOENT;
+
+    if (strchr(name, '/')) {
+        f = sb_font_load(name, cache);
+        err = errno;
+    } else if ((path = malloc(PATH_MAX)) != NULL) {
+        for (i = -1; !f && (i < 0 || font_dirs[i]); i++) {
+            const char *dir = i < 0 ? env : font_dirs[i];
+            if (!dir || !*dir)
+                continue;
+            for (sfx = 0; !f && sfx < 2; sfx++) {
+                snprintf(path, PATH_MAX, "%s/%s%s",
+                        dir, name, sfx ? ".flf" : "");
+                if (!(f = sb_font_load(path, cache)) && errno != ENOENT)
+                    err = errno;
+            } /* for */
+        } /* for */
+        free(path);
+    } /* if */
+    free(cache);
+    errno = err;
+    return f;
+} /* load_font */
+
+/* the width of the terminal at fd, 0 if it isn't one */
+size_t
+term_width(
+        int fd)
+{
+    struct winsize ws;
 
-    { 0, 0, NULL },
-};
+    if (ioctl(fd, TIOCGWINSZ, &ws) < 0)
+        return 0;
+    return ws.ws_col;
+} /* term_width */
 
-static struct chrinfo *
-getchrinfo(
-        wchar_t c)
+static void
+on_winch(
+        int sig)
 {
-    struct range *p;
+    resized = 1;
+} /* on_winch */
 
-    for (p = ranges; p->ci; p++) {
-        if (p->fst <= c & c < p->lst)
-            break;
-    }
+/* sets resized on SIGWINCH.  The system calls are not restarted, so
+ * a program waiting for input can relayout at once. */
+void
+watch_resize(void)
+{
+    struct sigaction sa;
 
-    return p->ci
-        ? p->ci + (c - p->fst)
-        : ci_invalid;
-} /* getchrinfo */
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = on_winch;
+    sigaction(SIGWINCH, &sa, NULL);
+} /* watch_resize */
 
-int flags = 0;
-#define FLAG_MONOSP         (1 << 0)
-#define FLAG_FRAME          (1 << 1)
-#define FLAG_UTF            (1 << 2)
-#define FLAG_ARGS_ARE_FILES (1 << 3)
-int max_width = 0;
+/* the wrapping width after a resize, the new width of the terminal
+ * unless one was given with -w */
+size_t
+resize_width(void)
+{
+    resized = 0;
+    if (wrap_auto)
+        wrap_width = term_width(out_fd);
+    return wrap_width;
+} /* resize_width */
 
 int
 main(
@@ -2246,36 +348,228 @@ main(
         char **argv)
 {
     int opt;
-
-    setlocale(LC_ALL, "");
-
-    while ((opt = getopt(argc, argv, "afmu")) != EOF) {
+    struct sb_ctx *ctx;
+    const char *serve_path = NULL;
+    const char *clock_spec = NULL;
+    int follow = 0;
+    int nthreads = 0, njobs = 0, ncache = 0;
+    const char *outdir = NULL;
+
+    while ((opt = getopt_long(argc, argv, "ac:fF:j:mo:rs:t:uw:",
+                    long_opts, NULL)) != EOF) {
         switch(opt) {
         case 'a': flags |= FLAG_ARGS_ARE_FILES; break;
+        case 'c':
+            ncache = atoi(optarg);
+            if (ncache < 1) {
+                fprintf(stderr,
+                        F("-c: %s: must be a positive number\n"),
+                        optarg);
+                exit(EXIT_FAILURE);
+            } /* if */
+            break;
         case 'f': flags |= FLAG_FRAME; break;
+        case 'F':
+            if (!(font = load_font(optarg))) {
+                fprintf(stderr,
+                        F("-F: %s: %s (errno = %d)\n"),
+                        optarg, errno == EINVAL
+                            ? "not a FIGlet font"
+                            : strerror(errno),
+                        errno);
+                exit(EXIT_FAILURE);
+            } /* if */
+            break;
+        case 'j':
+            njobs = atoi(optarg);
+            if (njobs < 1) {
+                fprintf(stderr,
+                        F("-j: %s: must be a positive number\n"),
+                        optarg);
+                exit(EXIT_FAILURE);
+            } /* if */
+            break;
         case 'm': flags |= FLAG_MONOSP; break;
+        case 'o': outdir = optarg; break;
+        case 'r': flags |= FLAG_REPAINT; break;
+        case 's': {
+            char *end;
+            long x = strtol(optarg, &end, 10), y = x;
+            if (end != optarg && *end == 'x')
+                y = strtol(end + 1, &end, 10);
+            if (*end || end == optarg || x < 1 || y < 1
+                    || x > SCALE_MAX || y > SCALE_MAX) {
+                fprintf(stderr,
+                        F("-s: %s: expected N or WxH, from 1 to %d\n"),
+                        optarg, SCALE_MAX);
+                exit(EXIT_FAILURE);
+            } /* if */
+            scale_x = x;
+            scale_y = y;
+            break;
+        } /* case */
+        case 't':
+            nthreads = atoi(optarg);
+            if (nthreads < 1) {
+                fprintf(stderr,
+                        F("-t: %s: must be a positive number\n"),
+                        optarg);
+                exit(EXIT_FAILURE);
+            } /* if */
+            break;
         case 'u': flags |= FLAG_UTF; break;
+        case 'w': {
+            char *end;
+            long n = strtol(optarg, &end, 10);
+            if (*end || end == optarg || n < 0) {
+                fprintf(stderr,
+                        F("-w: %s: must be a number of columns "
+                          "(0 not to wrap)\n"),
+                        optarg);
+                exit(EXIT_FAILURE);
+            } /* if */
+            wrap_width = n;
+            wrap_auto = 0;
+            break;
+        } /* case */
+        case OPT_SERVE: serve_path = optarg; break;
+        case OPT_CLOCK: clock_spec = optarg; break;
+        case OPT_FILL:
+            if (strlen(optarg) != 1) {
+                fprintf(stderr,
+                        F("--fill: %s: must be a single character\n"),
+                        optarg);
+                exit(EXIT_FAILURE);
+            } /* if */
+            style.fill = (unsigned char) optarg[0];
+            break;
+        case OPT_COLOR:
+            if (parse_color(optarg) < 0) {
+                fprintf(stderr,
+                        F("--color: %s: expected "
+                          "none|run|glyph|gradient[:SGR,...]\n"),
+                        optarg);
+                exit(EXIT_FAILURE);
+            } /* if */
+            break;
+        case OPT_FRAME_COLOR: style.frame = optarg; break;
+        case OPT_ENCODING:
+            if ((encoding = enc_name(optarg, strlen(optarg))) < 0) {
+                fprintf(stderr,
+                        F("--encoding: %s: expected utf8, latin1 "
+                          "or locale\n"),
+                        optarg);
+                exit(EXIT_FAILURE);
+            } /* if */
+            break;
+        case OPT_STATS:
+            if (!optarg || !strcmp(optarg, "text")) {
+                stats_format = STATS_TEXT;
+            } else if (!strcmp(optarg, "json")) {
+                stats_format = STATS_JSON;
+            } else {
+                fprintf(stderr,
+                        F("--stats: %s: expected text or json\n"),
+                        optarg);
+                exit(EXIT_FAILURE);
+            } /* if */
+            break;
+        case OPT_WRITEV: flags |= FLAG_WRITEV; break;
+        case OPT_FOLLOW: follow = 1; break;
+        case OPT_COALESCE: {
+            char *end;
+            long hz = strtol(optarg, &end, 10);
+            if (*end || end == optarg || hz < 1 || hz > HZ_MAX) {
+                fprintf(stderr,
+                        F("--coalesce: %s: expected the redraws per "
+                          "second, from 1 to %d\n"),
+                        optarg, HZ_MAX);
+                exit(EXIT_FAILURE);
+            } /* if */
+            coalesce_hz = hz;
+            flags |= FLAG_REPAINT;
+            break;
+        } /* case */
         } /* switch */
     } /* while */
 
     argc -= optind; argv += optind;
 
-    /* initialize tables */
-    struct range *r;
-    for (r = ranges; r->ci; r++) {
-        int c, i;
-        for (i = 0, c = r->fst; c < r->lst; i++, c++) {
-            int j;
+    /* the options that would be ignored */
+    if (outdir && (!(flags & FLAG_ARGS_ARE_FILES) || !argc
+                || flags & FLAG_REPAINT)) {
+        fprintf(stderr,
+                F("-o: only with -a and the files to render, "
+                  "and without -r\n"));
+        exit(EXIT_FAILURE);
+    } /* if */
+    if (ncache && (njobs || nthreads || flags & FLAG_REPAINT)) {
+        fprintf(stderr,
+                F("-c: can't be used with %s\n"),
+                njobs ? "-j" : nthreads ? "-t"
+                    : coalesce_hz ? "--coalesce" : "-r");
+        exit(EXIT_FAILURE);
+    } /* if */
 
-            for (j = 0; r->ci[i].s[j]; j++) {
-                int n = strlen(r->ci[i].s[j]);
-                if (r->ci[i].w < n) r->ci[i].w = n;
-            } /* for */
-            if (max_width < r->ci[i].w)
-                max_width = r->ci[i].w;
-            r->ci[i].h = j;
-        } /* for */
-    } /* for */
+    /* the locale is only loaded if it's needed, for an encoding not
+     * decoded by the library or for the clock (dates, names of the
+     * days and months) */
+    if (encoding < 0)
+        encoding = env_encoding();
+    if (encoding == SB_ENC_LOCALE || clock_spec)
+        setlocale(LC_ALL, "");
+    /* without -w, wrap to the terminal, if the output goes to one
+     * (not the server's, its banners go elsewhere) */
+    if (wrap_auto && !serve_path)
+        wrap_width = term_width(out_fd);
+    if (stats_format != STATS_NONE)
+        stats_start();
+
+    if (serve_path)
+        exit(serve(serve_path));
+    if (clock_spec)
+        exit(run_clock(clock_spec, flags));
+    if (follow) {
+        if (!argc) {
+            fprintf(stderr, F("--follow: no files to follow\n"));
+            exit(EXIT_FAILURE);
+        } /* if */
+        exit(run_follow(argv, argc, out_fd));
+    } /* if */
+
+    /* many files can be rendered in parallel, each as a whole */
+    if ((njobs || outdir) && flags & FLAG_ARGS_ARE_FILES
+            && !(flags & FLAG_REPAINT) && argc)
+        exit(run_files(njobs ? njobs : 1, argv, argc, outdir, out_fd));
+
+    /* big inputs (stdin or files) can be rendered in parallel.  The
+     * repaint mode is interactive, it gains nothing from this. */
+    if (nthreads && !(flags & FLAG_REPAINT)
+            && (!argc || flags & FLAG_ARGS_ARE_FILES))
+        exit(run_pipeline(nthreads, argc ? argv : NULL, argc, out_fd));
+
+    ctx = new_ctx(flags & FLAG_SB_MASK);
+    if (!ctx) {
+        fprintf(stderr,
+                F("sb_new: %s (errno = %d)\n"),
+                strerror(errno), errno);
+        exit(EXIT_FAILURE);
+    } /* if */
+    if (ncache && !(flags & FLAG_REPAINT) && !(cache = lru_new(ncache))) {
+        fprintf(stderr,
+                F("lru_new: %s (errno = %d)\n"),
+                strerror(errno), errno);
+        exit(EXIT_FAILURE);
+    } /* if */
+    if (flags & FLAG_REPAINT) {
+        if (!(screen = rp_new())) {
+            fprintf(stderr,
+                    F("rp_new: %s (errno = %d)\n"),
+                    strerror(errno), errno);
+            exit(EXIT_FAILURE);
+        } /* if */
+        watch_resize();
+    } /* if */
 
     if (argc) {
         int i;
@@ -2288,184 +582,322 @@ main(
                             argv[i], strerror(errno), errno);
                     exit(EXIT_FAILURE);
                 } /* if */
-                process(f);
+                process(ctx, f);
                 fclose(f);
             }
-        } else { /* ARGS are arguments */
-            size_t line_l = 0;
-            for (i = 0; i < argc; i++) {
-#define NELEM(_line) (sizeof (_line) / sizeof (_line)[0])
-                wchar_t line[1024], *p = line;
-                mbstate_t st;
-                size_t l = mbsrtowcs(
-                        line, (const char **)&argv[i],
-                        strlen(argv[i]), &st);
-                line[l] = 0;
-                line_l = proc_line(line, line_l);
-#undef NELEM
-            }
-            if (flags & FLAG_FRAME && line_l) {
-                hor_line(line_l,
-                    flags & FLAG_UTF
-                        ? "\u2558\u2550"
-                        : "`=",
-                    flags & FLAG_UTF
-                        ? "\u2550\u255b\n"
-                        : "='\n");
-            } /* if */
+        } else { /* ARGS are arguments, rendered in place */
+            for (i = 0; i < argc; i++)
+                proc_line(ctx, argv[i], strlen(argv[i]));
+            check(sb_close(ctx, sb_sink_fd, &out_fd), "sb_close");
         }
     } else {
-        process(stdin);
+        process(ctx, stdin);
     } /* else */
+    if (cache) {
+        lru_report(cache, stderr);
+        lru_free(cache);
+    } /* if */
+    free_ctx(ctx);
+    rp_free(screen);
+    sb_font_free(font);
 } /* main */
 
-static size_t
+static void
+check(
+        ssize_t res,
+        const char *what)
+{
+    if (res < 0) {
+        fprintf(stderr,
+                F("%s: %s (errno = %d)\n"),
+                what, strerror(errno), errno);
+        exit(EXIT_FAILURE);
+    } /* if */
+} /* check */
+
+/* renders the multibyte text line[0..len), up to the first newline
+ * (leading newlines skipped) */
+static void
 proc_line(
-        wchar_t *line,
-        size_t last_l)
+        struct sb_ctx *ctx,
+        const char *line,
+        size_t len)
 {
-    static long lineno = 0;
-    size_t this_l = 0;
-    wchar_t *ctx;
-    wchar_t *l = wcstok(line, L"\n", &ctx);
-    if (!l) l = L"";
-    size_t len = wcslen(l);
-    this_l = len ? (len - 1) * 2 : 0;
-    int i, h = 7;
-
-    for (i = 0; i < len; i++) {
-        struct chrinfo *p = getchrinfo(l[i]);
-        if (h < p->h) h = p->h;
-        this_l += flags & FLAG_MONOSP
-            ? max_width
-            : p->w;
-    } /* for */
+    const char *l = line, *nl;
 
-    if (flags & FLAG_FRAME && (last_l || this_l)) {
-        if (last_l == 0) {
-            hor_line(this_l,
-                flags & FLAG_UTF
-                    ? "\u2552\u2550"
-                    : ",=",
-                flags & FLAG_UTF
-                    ? "\u2550\u2555\n"
-                    : "=.\n");
-        } else if (this_l == 0) {
-            hor_line(last_l,
-                flags & FLAG_UTF
-                    ? "\u2558\u2550"
-                    : "`=",
-                flags & FLAG_UTF
-                    ? "\u2550\u255b\n"
-                    : "='\n");
-        } else if (last_l == this_l) {
-            hor_line(last_l,
-                flags & FLAG_UTF
-                    ? "\u255e\u2550"
-                    : ">=",
-                flags & FLAG_UTF
-                    ? "\u2550\u2561\n"
-                    : "=<\n");
-        } else { /* last_l != this_l, both != 0 */
-            size_t min = MIN(last_l, this_l);
-            size_t max = MAX(last_l, this_l);
-            hor_line(min + 1,
-                flags & FLAG_UTF
-                    ? "\u255e\u2550"
-                    : ">=",
-                flags & FLAG_UTF
-                    ? last_l > this_l
-                        ? "\u2564"
-                        : "\u2567"
-                    : last_l > this_l
-                        ? "v"
-                        : "^");
-            hor_line(max - min - 1,
-                "",
-                flags & FLAG_UTF
-                    ? last_l > this_l
-                        ? "\u255b\n"
-                        : "\u2555\n"
-                    : last_l > this_l
-                        ? "'\n"
-                        : ".\n");
-        } /* else */
-    } else {
-        if (lineno++) puts("");
+    while (len && *l == '\n') {
+        l++; len--;
+    } /* while */
+    if ((nl = memchr(l, '\n', len)) != NULL)
+        len = nl - l;
+
+    if (flags & FLAG_REPAINT) {
+        /* each line replaces the last banner on the screen */
+        rp_begin(screen);
+        sb_reset(ctx);
+        check(sb_render_utf8(ctx, l, len, rp_sink, screen),
+                "sb_render");
+        check(rp_mark(screen, ctx), "rp_mark");
+        check(sb_close(ctx, rp_sink, screen), "sb_close");
+        check(rp_paint(screen, out_fd), "rp_paint");
+        return;
     } /* if */
 
-    for (i = 0; i < h; i++) {
-        int j;
-        if (flags & FLAG_FRAME && len)
-            printf(flags & FLAG_UTF
-                ? "\u2502 "
-                : "| ");
-        for (j = 0; j < len; j++) {
-            struct chrinfo *p = getchrinfo(l[j]);
-            int pre1 = j
-                    ? 2
-                    : 0,
-                pre2 = flags & FLAG_MONOSP
-                    ? (max_width - p->w) >> 1
-                    : 0;
-            printf("%*s%-*s",
-                    pre1 + pre2, "",
-                    (int)(flags & FLAG_MONOSP
-                        ? max_width - pre2
-                        : p->w),
-                    i < p->h
-                        ? p->s[i]
-                        : "");
-        } /* for */
-        puts(flags & FLAG_FRAME && len
-            ? flags & FLAG_UTF
-                ? " \u2502"
-                : " |"
-            : "");
-    } /* for */
-    return this_l;
-}
+    if (cache) {
+        check(lru_render(cache, ctx, l, len, sb_sink_fd, &out_fd),
+                "lru_render");
+        return;
+    } /* if */
+    check(sb_render_utf8(ctx, l, len, sb_sink_fd, &out_fd),
+            "sb_render");
+} /* proc_line */
 
 static void
 process(
+        struct sb_ctx *ctx,
         FILE *f)
 {
-    wchar_t line[BUFSIZ];
-    size_t last_l = 0;
-
-    while (fgetws(line, sizeof line, f)) {
-        last_l = proc_line(line, last_l);
-    } /* while */
-    if (flags & FLAG_FRAME && last_l) {
-        hor_line(last_l,
-            flags & FLAG_UTF
-                ? "\u2558\u2550"
-                : "`=",
-            flags & FLAG_UTF
-                ? "\u2550\u255b\n"
-                : "='\n");
-    } /* if */
+    if (flags & FLAG_REPAINT && coalesce_hz)
+        coalesce(ctx, fileno(f));
+    else
+        live(ctx, fileno(f));
 } /* process */
 
+/* repaints the last line with the new width of the terminal */
 static void
-hor_line(
-        size_t len,
-        const char *lft,
-        const char *rgt)
+relayout(
+        struct sb_ctx *ctx)
 {
-    char *the_line = flags & FLAG_UTF
-        ?  "\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550"
-           "\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550"
-           "\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550"
-           "\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550"
-        :  "============================================================";
-    if (flags & FLAG_UTF) len *= 3;
-    size_t the_line_size = strlen(the_line);
-    printf("%s", lft);
-    while (len > the_line_size) {
-        printf("%s", the_line);
-        len -= the_line_size;
-    } /* while */
-    /* len <= the_line_size */
-    printf("%.*s%s", (int)len, the_line, rgt);
-} /* hor_line */
+    sb_set_width(ctx, resize_width());
+    rp_resize(screen);
+    rp_begin(screen);
+    sb_reset(ctx);
+    check(sb_relayout(ctx, rp_sink, screen), "sb_relayout");
+    check(rp_mark(screen, ctx), "rp_mark");
+    check(sb_close(ctx, rp_sink, screen), "sb_close");
+    check(rp_paint(screen, out_fd), "rp_paint");
+} /* relayout */
+
+/* the input, read with read(2) instead of stdio so a signal
+ * interrupts the wait for the next line without cutting it: a resize
+ * of the terminal lays out again the banner on the screen (in the
+ * repaint mode) and SIGUSR1 prints the statistics, at once.  Lines
+ * of any length: past LINE_PART bytes, a line is given to the
+ * library in parts (see sb_render_part()), unless the repaint mode or
+ * the cache need it whole, and the library hands long banners to the
+ * sink in chunks. */
+static void
+live(
+        struct sb_ctx *ctx,
+        int fd)
+{
+    char *buf = NULL;
+    size_t len = 0, cap = 0;
+    int shown = 0, cut = 0;
+    int parts = !(flags & FLAG_REPAINT) && !cache;
+
+    for (;;) {
+        char *p, *q, *nl;
+        ssize_t n;
+
+        if (cap - len < BUFSIZ) {
+            char *p = realloc(buf, cap = cap ? 2 * cap : 2 * BUFSIZ);
+            if (!p) {
+                fprintf(stderr,
+                        F("realloc: %s (errno = %d)\n"),
+                        strerror(errno), errno);
+                exit(EXIT_FAILURE);
+            } /* if */
+            buf = p;
+        } /* if */
+        n = read(fd, buf + len, cap - len);
+        if (n < 0 && errno == EINTR) {
+            if (resized && shown)
+                relayout(ctx);
+            stats_poll();
+            continue;
+        } /* if */
+        if (n < 0) {
+            fprintf(stderr,
+                    F("read: %s (errno = %d)\n"),
+                    strerror(errno), errno);
+            exit(EXIT_FAILURE);
+        } /* if */
+        if (n == 0)
+            break;
+        len += n;
+
+        /* the complete lines read, the rest is kept for later (it has
+         * no newline, only the bytes read are looked at) */
+        for (p = buf, q = buf + len - n;
+                (nl = memchr(q, '\n', buf + len - q)) != NULL;
+                p = q = nl + 1) {
+            if (cut)
+                check(sb_render_part(ctx, p, nl - p, 0,
+                            sb_sink_fd, &out_fd), "sb_render_part");
+            else
+                proc_line(ctx, p, nl + 1 - p);
+            cut = 0;
+            shown = 1;
+            stats_poll();
+        } /* for */
+        memmove(buf, p, len -= p - buf);
+        if (parts && len >= LINE_PART) {
+            check(sb_render_part(ctx, buf, len, 1, sb_sink_fd, &out_fd),
+                    "sb_render_part");
+            cut = 1;
+            len = 0;
+        } /* if */
+        if (resized && shown)
+            relayout(ctx);
+    } /* for */
+    if (cut)
+        check(sb_render_part(ctx, buf, len, 0, sb_sink_fd, &out_fd),
+                "sb_render_part");
+    else if (len)
+        proc_line(ctx, buf, len);
+    free(buf);
+    check(sb_close(ctx, sb_sink_fd, &out_fd), "sb_close");
+} /* live */
+
+/* the newest complete line of buf[0..*len) (or the last one, even
+ * without newline, at the end of the input), copied to line, and
+ * the bytes up to its end dropped from buf.  Returns 0 if there's
+ * none. */
+static int
+newest_line(
+        char *buf,
+        size_t *len,
+        int eof,
+        char **line,
+        size_t *line_len,
+        size_t *line_cap)
+{
+    char *end = NULL, *start, *p;
+    size_t drop;
+
+    if (eof && *len && buf[*len - 1] != '\n')
+        end = buf + *len;
+    for (p = buf + *len; !end && p > buf; p--)
+        if (p[-1] == '\n')
+            end = p - 1;
+    if (!end)
+        return 0;
+    for (start = end; start > buf && start[-1] != '\n'; start--)
+        continue;
+    if (*line_cap < (size_t) (end - start) + 1) {
+        char *l = realloc(*line, *line_cap = end - start + 1);
+        if (!l) {
+            fprintf(stderr,
+                    F("realloc: %s (errno = %d)\n"),
+                    strerror(errno), errno);
+            exit(EXIT_FAILURE);
+        } /* if */
+        *line = l;
+    } /* if */
+    memcpy(*line, start, *line_len = end - start);
+    drop = end - buf + (end < buf + *len);
+    memmove(buf, buf + drop, *len -= drop);
+    return 1;
+} /* newest_line */
+
+static long long
+mono_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+} /* mono_ns */
+
+/* the input of --coalesce: as live(), but all the input available is
+ * read before drawing, and only its newest complete line is drawn,
+ * at most coalesce_hz times per second, so a fast producer never
+ * makes the display fall behind.  The input is drained with poll(2)
+ * instead of setting O_NONBLOCK, as that flag would be shared with
+ * the writer of the pipe or the terminal. */
+static void
+coalesce(
+        struct sb_ctx *ctx,
+        int fd)
+{
+    char *buf = NULL, *line = NULL;
+    size_t len = 0, cap = 0, line_len = 0, line_cap = 0;
+    long long period = 1000000000LL / coalesce_hz, next = 0;
+    int pending = 0, shown = 0, eof = 0;
+
+    for (;;) {
+        struct pollfd p;
+        long long now = mono_ns();
+        int timeout = -1, n;
+
+        if (pending && now >= next) {
+            proc_line(ctx, line, line_len);
+            pending = 0;
+            shown = 1;
+            next = now + period;
+            stats_poll();
+            continue;
+        } /* if */
+        if (pending) /* until the next frame, rounded up */
+            timeout = (next - now + 999999) / 1000000;
+        if (eof && !pending)
+            break;
+
+        p.fd = fd;
+        p.events = POLLIN;
+        n = poll(&p, !eof, timeout);
+        if (n < 0 && errno == EINTR) {
+            if (resized && shown)
+                relayout(ctx);
+            stats_poll();
+            continue;
+        } /* if */
+        if (n < 0) {
+            fprintf(stderr,
+                    F("poll: %s (errno = %d)\n"),
+                    strerror(errno), errno);
+            exit(EXIT_FAILURE);
+        } /* if */
+
+        /* all that's there, without waiting for more, unless it's
+         * time to draw */
+        while (n > 0 && !eof) {
+            ssize_t r;
+            if (len == cap) {
+                char *b = realloc(buf, cap = cap ? 2 * cap : BUFSIZ);
+                if (!b) {
+                    fprintf(stderr,
+                            F("realloc: %s (errno = %d)\n"),
+                            strerror(errno), errno);
+                    exit(EXIT_FAILURE);
+                } /* if */
+                buf = b;
+            } /* if */
+            r = read(fd, buf + len, cap - len);
+            if (r < 0 && errno == EINTR) {
+                stats_poll();
+                continue;
+            } /* if */
+            if (r < 0) {
+                fprintf(stderr,
+                        F("read: %s (errno = %d)\n"),
+                        strerror(errno), errno);
+                exit(EXIT_FAILURE);
+            } /* if */
+            eof = r == 0;
+            len += r;
+            if (newest_line(buf, &len, eof, &line, &line_len, &line_cap))
+                pending = 1;
+            if (pending && mono_ns() >= next)
+                break;
+            if (!eof)
+                n = poll(&p, 1, 0);
+        } /* while */
+        if (resized && shown)
+            relayout(ctx);
+    } /* for */
+    free(buf);
+    free(line);
+    check(sb_close(ctx, sb_sink_fd, &out_fd), "sb_close");
+} /* coalesce */
@@ -0,0 +1,73 @@
+/* banner.h --- internal declarations of the sysvbanner program.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 06:02:19 EEST 2026
+ */
+#ifndef _BANNER_H
+#define _BANNER_H
+
+#include <signal.h>
+#include <stdio.h>
+
+#include "sysvbanner.h"
+
+#define F(fmt) __FILE__":%d:%s: " fmt, __LINE__, __func__
+
+extern int flags;
+#define FLAG_MONOSP         SB_MONOSP
+#define FLAG_FRAME          SB_FRAME
+#define FLAG_UTF            SB_UTF
+#define FLAG_WRITEV         SB_WRITEV
+#define FLAG_ARGS_ARE_FILES (1 << 8)
+#define FLAG_REPAINT        (1 << 9)
+#define FLAG_SB_MASK        (SB_MONOSP | SB_FRAME | SB_UTF | SB_WRITEV)
+
+/* banner.c, the style given in the command line */
+extern struct sb_style style;
+extern int encoding;
+int styled(void);
+struct sb_ctx *new_ctx(int flags);
+void free_ctx(struct sb_ctx *ctx);
+
+/* banner.c, wrapping: the width (0 for none) and the terminal's */
+extern size_t wrap_width;
+extern volatile sig_atomic_t resized;
+size_t term_width(int fd);
+void watch_resize(void);
+size_t resize_width(void);
+
+/* server.c */
+int serve(const char *path);
+
+/* pipeline.c, names NULL to read stdin */
+int run_pipeline(int nthreads, char **names, int nnames, int fd);
+
+/* multi.c, outdir NULL to write to fd in order */
+int run_files(int nthreads, char **names, int nnames,
+        const char *outdir, int fd);
+
+/* cache.c */
+struct lru *lru_new(size_t max);
+void lru_free(struct lru *c);
+ssize_t lru_render(struct lru *c, struct sb_ctx *ctx,
+        const char *s, size_t len, sb_sink *sink, void *arg);
+void lru_report(struct lru *c, FILE *f);
+
+/* stats.c, --stats */
+#define STATS_NONE  0
+#define STATS_TEXT  1
+#define STATS_JSON  2
+extern int stats_format;
+extern volatile sig_atomic_t stats_due;
+void stats_start(void);
+void stats_add(struct sb_ctx *ctx);
+void stats_drop(struct sb_ctx *ctx);
+void stats_report(FILE *f);
+void stats_poll(void);
+
+/* clock.c */
+int run_clock(const char *spec, int flags);
+
+/* follow.c */
+int run_follow(char **names, int nnames, int fd);
+
+#endif /* _BANNER_H */
@@ -0,0 +1,438 @@
+/* bench.c --- end to end benchmark of the rendering library.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 12:31:09 EEST 2026
+ *
+ * sbbench (run with make bench) renders some representative corpora,
+ * generated here so the runs are always the same, with every
+ * combination of the rendering options, through sb_render_utf8() and
+ * sb_close() as sysvbanner does, into a sink that just counts the
+ * output.  For each case it reports the input characters and output
+ * bytes per second, and the percentiles of the time taken by a line.
+ *
+ * The results can be saved (-b) as a baseline, and later runs
+ * compared (-c) against it: a case whose throughput is lower, or
+ * whose median line latency is higher, by more than the threshold
+ * (-t, a percentage) is reported as a regression, and the exit code
+ * is 1.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sysvbanner.h"
+
+#define F(fmt) __FILE__":%d:%s: " fmt, __LINE__, __func__
+
+#define BENCH_MAX_SAMPLES   (1 << 20)   /* line latencies kept per case */
+#define BENCH_MAX_CASES     64
+
+struct buffer {
+    char   *b;
+    size_t  len, cap;
+};
+
+struct corpus {
+    const char     *name;
+    void          (*make)(struct buffer *b);
+    struct buffer   text;
+    size_t         *line;       /* line k is text[line[k]..line[k+1] - 1) */
+    size_t          nlines;
+    size_t          nchars;     /* characters, not bytes */
+};
+
+struct result {
+    char            corpus[32], opts[8];
+    double          chars_s, mb_s;
+    double          p50, p90, p99, max;     /* microseconds */
+};
+
+static const struct option_set {
+    const char *name;
+    int         flags;
+} option_sets[] = {
+    { "-",      0 },
+    { "-f",     SB_FRAME },
+    { "-m",     SB_MONOSP },
+    { "-u",     SB_UTF },
+    { "-fu",    SB_FRAME | SB_UTF },
+    { "-fmu",   SB_FRAME | SB_MONOSP | SB_UTF },
+    { NULL,     0 },
+};
+
+static uint32_t seed = 12345;
+
+/* a small LCG, the corpora must be the same on every run */
+static unsigned
+rnd(
+        unsigned n)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) % n;
+} /* rnd */
+
+static void
+add(
+        struct buffer *b,
+        const char *s,
+        size_t n)
+{
+    if (b->len + n > b->cap) {
+        size_t cap = b->cap ? b->cap : BUFSIZ;
+        while (cap < b->len + n) cap <<= 1;
+        if (!(b->b = realloc(b->b, cap))) {
+            fprintf(stderr, F("realloc: out of memory\n"));
+            exit(EXIT_FAILURE);
+        } /* if */
+        b->cap = cap;
+    } /* if */
+    memcpy(b->b + b->len, s, n);
+    b->len += n;
+} /* add */
+
+/* adds the code point c, UTF-8 encoded */
+static void
+add_utf8(
+        struct buffer *b,
+        unsigned c)
+{
+    char u[3];
+
+    if (c < 0x80) {
+        u[0] = c;
+        add(b, u, 1);
+    } else if (c < 0x800) {
+        u[0] = 0xc0 | c >> 6;
+        u[1] = 0x80 | (c & 0x3f);
+        add(b, u, 2);
+    } else {
+        u[0] = 0xe0 | c >> 12;
+        u[1] = 0x80 | (c >> 6 & 0x3f);
+        u[2] = 0x80 | (c & 0x3f);
+        add(b, u, 3);
+    } /* if */
+} /* add_utf8 */
+
+/* lines of words of code points in [lo, hi) */
+static void
+words(
+        struct buffer *b,
+        size_t nlines,
+        size_t minlen,
+        size_t maxlen,
+        unsigned lo,
+        unsigned hi)
+{
+    size_t i, j, n;
+
+    for (i = 0; i < nlines; i++) {
+        n = minlen + rnd(maxlen - minlen + 1);
+        for (j = 0; j < n; j++)
+            add_utf8(b, j && !rnd(6) ? ' ' : lo + rnd(hi - lo));
+        add(b, "\n", 1);
+    } /* for */
+} /* words */
+
+static void
+mk_ascii(
+        struct buffer *b)
+{
+    words(b, 20000, 10, 70, '!', 0x7f);
+} /* mk_ascii */
+
+/* the latin1_1 table */
+static void
+mk_latin1(
+        struct buffer *b)
+{
+    words(b, 20000, 10, 70, 0xa1, 0x100);
+} /* mk_latin1 */
+
+/* Greek and CJK, not in the font, drawn with the invalid glyph */
+static void
+mk_invalid(
+        struct buffer *b)
+{
+    words(b, 10000, 10, 70, 0x391, 0x3c9);
+    words(b, 10000, 10, 70, 0x4e00, 0x9fff);
+} /* mk_invalid */
+
+static void
+mk_long(
+        struct buffer *b)
+{
+    words(b, 16, 65536, 65536, '!', 0x7f);
+} /* mk_long */
+
+static void
+mk_short(
+        struct buffer *b)
+{
+    words(b, 200000, 1, 4, '!', 0x7f);
+} /* mk_short */
+
+static struct corpus corpora[] = {
+    { "ascii",      mk_ascii },
+    { "latin1",     mk_latin1 },
+    { "invalid",    mk_invalid },
+    { "long",       mk_long },
+    { "short",      mk_short },
+    { NULL,         NULL },
+};
+
+/* notes that a line ends at offset end of the text */
+static void
+add_line(
+        struct corpus *c,
+        size_t end,
+        size_t *cap)
+{
+    if (c->nlines + 2 > *cap) {
+        *cap = *cap ? 2 * *cap : 1024;
+        if (!(c->line = realloc(c->line, *cap * sizeof *c->line))) {
+            fprintf(stderr, F("realloc: out of memory\n"));
+            exit(EXIT_FAILURE);
+        } /* if */
+    } /* if */
+    c->line[++c->nlines] = end;
+} /* add_line */
+
+static void
+corpus_init(
+        struct corpus *c)
+{
+    size_t i, cap = 0;
+
+    c->make(&c->text);
+    c->nlines = -1;     /* line[0] is the start */
+    add_line(c, 0, &cap);
+    for (i = 0; i < c->text.len; i++) {
+        if (c->text.b[i] == '\n')
+            add_line(c, i + 1, &cap);
+        else if ((c->text.b[i] & 0xc0) != 0x80)
+            c->nchars++;
+    } /* for */
+} /* corpus_init */
+
+/* the output is only counted */
+static int
+count_sink(
+        void *arg,
+        const char *buf,
+        size_t len)
+{
+    *(size_t *) arg += len;
+    return 0;
+} /* count_sink */
+
+static uint64_t
+now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+} /* now_ns */
+
+static int
+cmp_u64(
+        const void *a,
+        const void *b)
+{
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+    return x < y ? -1 : x > y;
+} /* cmp_u64 */
+
+static double
+percentile(
+        const uint64_t *s,
+        size_t n,
+        double p)
+{
+    return s[(size_t) (p * (n - 1))] / 1000.0;
+} /* percentile */
+
+/* renders the corpus with the options until secs have passed (at
+ * least once) */
+static void
+run(
+        struct corpus *c,
+        const struct option_set *o,
+        double secs,
+        uint64_t *samples,
+        struct result *r)
+{
+    struct sb_ctx *ctx = sb_new(o->flags);
+    size_t out = 0, chars = 0, n = 0, k;
+    uint64_t t0 = now_ns(), t, elapsed;
+
+    if (!ctx) {
+        fprintf(stderr,
+                F("sb_new: %s (errno = %d)\n"),
+                strerror(errno), errno);
+        exit(EXIT_FAILURE);
+    } /* if */
+    do {
+        for (k = 0; k < c->nlines; k++) {
+            t = now_ns();
+            if (sb_render_utf8(ctx, c->text.b + c->line[k],
+                    c->line[k + 1] - c->line[k] - 1,
+                    count_sink, &out) < 0) {
+                fprintf(stderr,
+                        F("sb_render_utf8: %s (errno = %d)\n"),
+                        strerror(errno), errno);
+                exit(EXIT_FAILURE);
+            } /* if */
+            if (n < BENCH_MAX_SAMPLES)
+                samples[n++] = now_ns() - t;
+        } /* for */
+        sb_close(ctx, count_sink, &out);
+        sb_reset(ctx);
+        chars += c->nchars;
+        elapsed = now_ns() - t0;
+    } while (elapsed < secs * 1e9);
+    sb_free(ctx);
+
+    qsort(samples, n, sizeof *samples, cmp_u64);
+    snprintf(r->corpus, sizeof r->corpus, "%s", c->name);
+    snprintf(r->opts, sizeof r->opts, "%s", o->name);
+    r->chars_s = chars / (elapsed / 1e9);
+    r->mb_s = out / (elapsed / 1e9) / 1e6;
+    r->p50 = percentile(samples, n, 0.50);
+    r->p90 = percentile(samples, n, 0.90);
+    r->p99 = percentile(samples, n, 0.99);
+    r->max = percentile(samples, n, 1.0);
+} /* run */
+
+static int
+save(
+        const char *name,
+        const struct result *r,
+        size_t n)
+{
+    FILE *f = fopen(name, "w");
+    size_t i;
+
+    if (!f) return -1;
+    fprintf(f, "# corpus opts chars/s MB/s p50 p90 p99 max (us)\n");
+    for (i = 0; i < n; i++)
+        fprintf(f, "%s %s %.0f %.3f %.3f %.3f %.3f %.3f\n",
+                r[i].corpus, r[i].opts, r[i].chars_s, r[i].mb_s,
+                r[i].p50, r[i].p90, r[i].p99, r[i].max);
+    return fclose(f);
+} /* save */
+
+static size_t
+load(
+        const char *name,
+        struct result *r,
+        size_t max)
+{
+    FILE *f = fopen(name, "r");
+    char line[256];
+    size_t n = 0;
+
+    if (!f) {
+        fprintf(stderr,
+                F("%s: %s (errno = %d)\n"),
+                name, strerror(errno), errno);
+        exit(EXIT_FAILURE);
+    } /* if */
+    while (n < max && fgets(line, sizeof line, f)) {
+        if (line[0] == '#')
+            continue;
+        if (sscanf(line, "%31s %7s %lf %lf %lf %lf %lf %lf",
+                r[n].corpus, r[n].opts, &r[n].chars_s, &r[n].mb_s,
+                &r[n].p50, &r[n].p90, &r[n].p99, &r[n].max) == 8)
+            n++;
+    } /* while */
+    fclose(f);
+    return n;
+} /* load */
+
+static void
+usage(void)
+{
+    fprintf(stderr,
+            "usage: sbbench [-s secs] [-b baseline] "
+            "[-c baseline [-t percent]]\n");
+    exit(EXIT_FAILURE);
+} /* usage */
+
+int
+main(
+        int argc,
+        char **argv)
+{
+    static struct result res[BENCH_MAX_CASES], base[BENCH_MAX_CASES];
+    const char *save_to = NULL, *compare = NULL;
+    double secs = 0.5, threshold = 10.0;
+    size_t nres = 0, nbase = 0, i;
+    int opt, regressions = 0;
+    uint64_t *samples = malloc(BENCH_MAX_SAMPLES * sizeof *samples);
+    struct corpus *c;
+    const struct option_set *o;
+
+    while ((opt = getopt(argc, argv, "b:c:s:t:")) != EOF) {
+        switch (opt) {
+        case 'b': save_to = optarg; break;
+        case 'c': compare = optarg; break;
+        case 's': secs = atof(optarg); break;
+        case 't': threshold = atof(optarg); break;
+        default: usage();
+        } /* switch */
+    } /* while */
+    if (optind < argc || !samples)
+        usage();
+    if (compare)
+        nbase = load(compare, base, BENCH_MAX_CASES);
+
+    printf("%-8s %-5s %12s %9s %9s %9s %9s %9s\n",
+            "corpus", "opts", "chars/s", "MB/s",
+            "p50 us", "p90 us", "p99 us", "max us");
+    for (c = corpora; c->name; c++) {
+        corpus_init(c);
+        for (o = option_sets; o->name; o++) {
+            struct result *r = &res[nres++];
+            run(c, o, secs, samples, r);
+            printf("%-8s %-5s %12.0f %9.2f %9.2f %9.2f %9.2f %9.2f",
+                    r->corpus, r->opts, r->chars_s, r->mb_s,
+                    r->p50, r->p90, r->p99, r->max);
+            for (i = 0; i < nbase; i++) {
+                const struct result *b = &base[i];
+                double dt, dl;
+                if (strcmp(b->corpus, r->corpus) || strcmp(b->opts, r->opts))
+                    continue;
+                dt = 100.0 * (r->chars_s - b->chars_s) / b->chars_s;
+                dl = 100.0 * (r->p50 - b->p50) / b->p50;
+                printf("  %+6.1f%%", dt);
+                if (dt < -threshold || dl > threshold) {
+                    printf("  REGRESSION (p50 %+.1f%%)", dl);
+                    regressions++;
+                } /* if */
+                break;
+            } /* for */
+            printf("\n");
+            fflush(stdout);
+        } /* for */
+        free(c->text.b);
+        free(c->line);
+    } /* for */
+    free(samples);
+
+    if (save_to && save(save_to, res, nres) != 0) {
+        fprintf(stderr,
+                F("%s: %s (errno = %d)\n"),
+                save_to, strerror(errno), errno);
+        exit(EXIT_FAILURE);
+    } /* if */
+    if (compare)
+        printf("%d regressions over %.1f%% against %s\n",
+                regressions, threshold, compare);
+    exit(regressions ? 1 : EXIT_SUCCESS);
+} /* main */
@@ -0,0 +1,81 @@
+/* bitmap.h --- packed glyph rows and their expansion into bytes.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 05:02:40 EEST 2026
+ *
+ * Each glyph row is stored as a single word, bit i being set when
+ * column i (counting from the left) is inked.  bm_expand() converts
+ * one row into ink/blank bytes.  It uses AVX2 or SSE2 when the
+ * compiler targets them (compile with -mavx2 to get the former, or
+ * define BM_SCALAR to force the portable version).
+ */
+#ifndef _BITMAP_H
+#define _BITMAP_H
+
+#include <stdint.h>
+#include <string.h>
+
+#if !defined(BM_SCALAR) && defined(__AVX2__)
+#include <immintrin.h>
+#elif !defined(BM_SCALAR) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+typedef uint32_t bm_row;
+
+/* maximum width of a glyph, in columns */
+#define BM_MAXW     32
+
+/* bm_expand() can write up to this number of bytes past dst,
+ * whatever the width requested, so the buffer must have room for
+ * them (only the first w bytes are meaningful). */
+#define BM_SLACK    32
+
+/* byte x replicated on the eight bytes of a 64 bit word */
+#define BM_BCAST(x) ((uint64_t)((x) & 0xff) * 0x0101010101010101ULL)
+
+/* one bit selected on each byte, bit 0 on byte 0 */
+#define BM_SEL      0x8040201008040201ULL
+
+static inline char *
+bm_expand(
+        char *dst,
+        bm_row bits,
+        unsigned w,
+        int ink,
+        int blank)
+{
+#if !defined(BM_SCALAR) && defined(__AVX2__)
+    const __m256i sel = _mm256_set1_epi64x(BM_SEL);
+    __m256i v = _mm256_set_epi64x(
+            BM_BCAST(bits >> 24), BM_BCAST(bits >> 16),
+            BM_BCAST(bits >>  8), BM_BCAST(bits));
+    __m256i m = _mm256_cmpeq_epi8(_mm256_and_si256(v, sel), sel);
+    _mm256_storeu_si256((__m256i *) dst,
+            _mm256_blendv_epi8(
+                _mm256_set1_epi8(blank),
+                _mm256_set1_epi8(ink), m));
+#elif !defined(BM_SCALAR) && defined(__SSE2__)
+    const __m128i sel = _mm_set1_epi64x(BM_SEL);
+    const __m128i i_v = _mm_set1_epi8(ink);
+    const __m128i b_v = _mm_set1_epi8(blank);
+    char *p = dst;
+    unsigned n;
+
+    for (n = 0; n < w; n += 16, p += 16, bits >>= 16) {
+        __m128i v = _mm_set_epi64x(BM_BCAST(bits >> 8), BM_BCAST(bits));
+        __m128i m = _mm_cmpeq_epi8(_mm_and_si128(v, sel), sel);
+        _mm_storeu_si128((__m128i *) p,
+                _mm_or_si128(
+                    _mm_and_si128(m, i_v),
+                    _mm_andnot_si128(m, b_v)));
+    } /* for */
+#else
+    unsigned n;
+
+    for (n = 0; n < w; n++, bits >>= 1)
+        dst[n] = bits & 1 ? ink : blank;
+#endif
+    return dst + w;
+} /* bm_expand */
+
+#endif /* _BITMAP_H */
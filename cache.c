@@ -0,0 +1,283 @@
+/* cache.c --- cache of rendered lines.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 11:02:44 EEST 2026
+ *
+ * Inputs like alert streams repeat the same few lines over and over.
+ * With -c N, the bodies of the last N different lines rendered (their
+ * glyph rows, see sb_body()) are kept, keyed on the text, the
+ * rendering flags and the wrapping width, and a repeated line costs a
+ * lookup and a write of the body kept.
+ * The frame lines between banners depend on the previous line, so
+ * they are not cached, they're drawn with sb_join() each time.
+ * A line found in the cache is credited in the statistics of the
+ * context (--stats) with what its rendering counted, so they are the
+ * same as without -c (but for the time spent).
+ * The lines whose bodies could be too big to keep (by their
+ * sb_estimate()) are not even looked up, they're rendered straight
+ * to the output, as without -c.
+ *
+ * The entries are in a hash table with chaining and in a list in
+ * order of use, the least recently used one is dropped when the
+ * cache is full.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "banner.h"
+
+#define LRU_MAX_BODY    (256 * 1024)    /* bigger bodies aren't kept,
+                                         * as estimated */
+
+struct buffer {
+    char   *b;
+    size_t  len, cap;
+};
+
+struct entry {
+    struct entry   *next;       /* in the hash chain */
+    struct entry   *newer, *older;  /* in the use list */
+    uint64_t        hash;
+    int             flags;
+    size_t          width[2];
+    size_t          cols;       /* the wrapping width */
+    size_t          key_len, body_len;
+    struct sb_stats st;         /* counted rendering the body */
+    char            data[];     /* the key, then the body */
+};
+
+struct lru {
+    struct entry  **tab;
+    size_t          mask;
+    struct entry   *newest, *oldest;
+    size_t          n, max;
+    struct buffer   tmp;        /* body of a line not cached yet */
+    unsigned long   lookups, hits, evictions;
+    unsigned long   too_big;    /* lines not cacheable */
+    size_t          bytes;      /* kept in entries */
+};
+
+static int
+buf_add(
+        struct buffer *b,
+        const char *s,
+        size_t n)
+{
+    if (b->len + n > b->cap) {
+        size_t cap = b->cap ? b->cap : BUFSIZ;
+        char *p;
+        while (cap < b->len + n) cap <<= 1;
+        p = realloc(b->b, cap);
+        if (!p) return -1;
+        b->b = p;
+        b->cap = cap;
+    } /* if */
+    memcpy(b->b + b->len, s, n);
+    b->len += n;
+    return 0;
+} /* buf_add */
+
+static int
+buf_sink(
+        void *arg,
+        const char *s,
+        size_t n)
+{
+    return buf_add(arg, s, n);
+} /* buf_sink */
+
+/* FNV-1a */
+static uint64_t
+hash(
+        const char *s,
+        size_t n,
+        int flags)
+{
+    uint64_t h = 0xcbf29ce484222325ULL ^ (unsigned) flags;
+
+    while (n--) {
+        h ^= (unsigned char) *s++;
+        h *= 0x100000001b3ULL;
+    } /* while */
+    return h;
+} /* hash */
+
+struct lru *
+lru_new(
+        size_t max)
+{
+    struct lru *c = calloc(1, sizeof *c);
+    size_t n;
+
+    if (!c) return NULL;
+    /* a load factor under 1 */
+    for (n = 16; n < max; n <<= 1)
+        continue;
+    c->tab = calloc(n, sizeof *c->tab);
+    if (!c->tab) {
+        free(c);
+        return NULL;
+    } /* if */
+    c->mask = n - 1;
+    c->max = max;
+    return c;
+} /* lru_new */
+
+void
+lru_free(
+        struct lru *c)
+{
+    struct entry *e, *next;
+
+    if (!c) return;
+    for (e = c->newest; e; e = next) {
+        next = e->older;
+        free(e);
+    } /* for */
+    free(c->tab);
+    free(c->tmp.b);
+    free(c);
+} /* lru_free */
+
+static void
+unlink_use(
+        struct lru *c,
+        struct entry *e)
+{
+    if (e->newer) e->newer->older = e->older;
+    else c->newest = e->older;
+    if (e->older) e->older->newer = e->newer;
+    else c->oldest = e->newer;
+} /* unlink_use */
+
+static void
+link_use(
+        struct lru *c,
+        struct entry *e)
+{
+    e->newer = NULL;
+    e->older = c->newest;
+    if (c->newest) c->newest->newer = e;
+    else c->oldest = e;
+    c->newest = e;
+} /* link_use */
+
+static void
+evict(
+        struct lru *c)
+{
+    struct entry *e = c->oldest, **pp;
+
+    for (pp = &c->tab[e->hash & c->mask]; *pp != e; pp = &(*pp)->next)
+        continue;
+    *pp = e->next;
+    unlink_use(c, e);
+    c->bytes -= e->key_len + e->body_len;
+    c->n--;
+    c->evictions++;
+    free(e);
+} /* evict */
+
+/* the cached body of s, rendering and keeping it if it isn't there.
+ * Returns NULL on error. */
+static struct entry *
+lookup(
+        struct lru *c,
+        struct sb_ctx *ctx,
+        const char *s,
+        size_t len)
+{
+    int fl = sb_flags(ctx);
+    size_t cols = wrap_width;
+    uint64_t h = hash(s, len, fl) ^ cols;
+    struct entry *e, **pp = &c->tab[h & c->mask];
+    struct sb_stats s0, s1;
+    size_t width[2];
+    int i;
+
+    c->lookups++;
+    for (e = *pp; e; e = e->next) {
+        if (e->hash == h && e->flags == fl && e->cols == cols
+                && e->key_len == len
+                && !memcmp(e->data, s, len)) {
+            c->hits++;
+            unlink_use(c, e);
+            link_use(c, e);
+            sb_add_stats(ctx, &e->st);
+            return e;
+        } /* if */
+    } /* for */
+
+    c->tmp.len = 0;
+    sb_get_stats(ctx, &s0);
+    if (sb_body(ctx, s, len, width, buf_sink, &c->tmp) < 0)
+        return NULL;
+    sb_get_stats(ctx, &s1);
+
+    if (c->n >= c->max)
+        evict(c);
+    e = malloc(sizeof *e + len + c->tmp.len);
+    if (!e) return NULL;
+    e->hash = h;
+    e->flags = fl;
+    memcpy(e->width, width, sizeof width);
+    e->cols = cols;
+    e->key_len = len;
+    e->body_len = c->tmp.len;
+    /* the counts, not the time */
+    memset(&e->st, 0, sizeof e->st);
+    e->st.lines = s1.lines - s0.lines;
+    e->st.glyphs = s1.glyphs - s0.glyphs;
+    for (i = 0; i < SB_NRANGES; i++)
+        e->st.range[i] = s1.range[i] - s0.range[i];
+    e->st.invalid = s1.invalid - s0.invalid;
+    e->st.row_bytes = s1.row_bytes - s0.row_bytes;
+    e->st.frame_bytes = s1.frame_bytes - s0.frame_bytes;
+    memcpy(e->data, s, len);
+    memcpy(e->data + len, c->tmp.b, c->tmp.len);
+    e->next = *pp;
+    *pp = e;
+    link_use(c, e);
+    c->n++;
+    c->bytes += len + c->tmp.len;
+    return e;
+} /* lookup */
+
+ssize_t
+lru_render(
+        struct lru *c,
+        struct sb_ctx *ctx,
+        const char *s,
+        size_t len,
+        sb_sink *sink,
+        void *arg)
+{
+    struct entry *e;
+
+    if (sb_estimate(ctx, len) > LRU_MAX_BODY) {
+        c->too_big++;
+        return sb_render_utf8(ctx, s, len, sink, arg);
+    } /* if */
+    if (!(e = lookup(c, ctx, s, len)))
+        return -1;
+    return sb_join_body(ctx, e->width, e->data + e->key_len, e->body_len,
+            sink, arg);
+} /* lru_render */
+
+void
+lru_report(
+        struct lru *c,
+        FILE *f)
+{
+    fprintf(f,
+            "cache: %lu lookups, %lu hits (%.1f%%), %lu misses, "
+            "%lu evictions, %zu/%zu entries, %zu bytes, "
+            "%lu lines too big\n",
+            c->lookups, c->hits,
+            c->lookups ? 100.0 * c->hits / c->lookups : 0.0,
+            c->lookups - c->hits, c->evictions,
+            c->n, c->max, c->bytes, c->too_big);
+} /* lru_report */
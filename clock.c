@@ -0,0 +1,158 @@
+/* clock.c --- big clock on a text screen, natively.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 06:40:55 EEST 2026
+ *
+ * This is the in-process version of the clock script: the time is
+ * formatted with strftime(3), rendered with the library and
+ * repainted in place (only the glyphs that changed, see repaint.c),
+ * waking up at each second boundary instead of forking date(1),
+ * sysvbanner and friends several times a second.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "banner.h"
+#include "repaint.h"
+
+#define CLK_MAX_TEXT    256
+
+/* the presets of the clock script */
+static struct preset {
+    const char *name;
+    size_t      prefix;     /* chars that must match, 0 for all */
+    const char *format;
+} presets[] = {
+    { "complete",   0, "w%W-j%j%n%x %a%n%X %Z" },
+    { "full",       0, "w%W-j%j%n%x %a%n%X %Z" },
+    { "timezone",   5, "%X %Z" },
+    { "time",       4, "%X" },
+    { "short",      5, "%H:%M" },
+    { "",           0, "%X %Z" },
+    { "epoch",      0, "%s" },
+    { "unix",       0, "%s" },
+    { "date",       4, "%x %a%n%X %Z" },
+    { NULL,         0, NULL },
+};
+
+static volatile sig_atomic_t stop;
+
+static void
+on_signal(
+        int sig)
+{
+    stop = 1;
+} /* on_signal */
+
+static const char *
+clk_format(
+        const char *s)
+{
+    struct preset *p;
+
+    for (p = presets; p->name; p++) {
+        if (p->prefix
+                ? !strncmp(s, p->name, p->prefix)
+                : !strcmp(s, p->name))
+            return p->format;
+    } /* for */
+    return s;
+} /* clk_format */
+
+/* renders text (one banner line per text line) into the screen */
+static int
+clk_render(
+        struct sb_ctx *ctx,
+        const char *text,
+        struct rp_screen *scr)
+{
+    const char *nl;
+
+    rp_begin(scr);
+    sb_reset(ctx);
+    for (;;) {
+        nl = strchr(text, '\n');
+        size_t n = nl ? nl - text : strlen(text);
+        if (sb_render_utf8(ctx, text, n, rp_sink, scr) < 0
+                || rp_mark(scr, ctx) < 0)
+            return -1;
+        if (!nl) break;
+        text = nl + 1;
+    } /* for */
+    return sb_close(ctx, rp_sink, scr) < 0 ? -1 : 0;
+} /* clk_render */
+
+int
+run_clock(
+        const char *spec,
+        int fl)
+{
+    const char *fmt = clk_format(spec);
+    struct rp_screen *scr = rp_new();
+    char text[CLK_MAX_TEXT], old[CLK_MAX_TEXT] = "";
+    struct sigaction sa;
+    struct sb_ctx *ctx;
+    int painted = 0;
+
+    /* like the clock script, frame the clock if no option is given */
+    ctx = new_ctx(fl & FLAG_SB_MASK ? fl & FLAG_SB_MASK : SB_FRAME);
+    if (!ctx || !scr) {
+        fprintf(stderr,
+                F("sb_new: %s (errno = %d)\n"),
+                strerror(errno), errno);
+        return EXIT_FAILURE;
+    } /* if */
+
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    watch_resize();
+
+    while (!stop) {
+        struct timespec now;
+        struct tm tm;
+
+        clock_gettime(CLOCK_REALTIME, &now);
+        localtime_r(&now.tv_sec, &tm);
+        if (strftime(text, sizeof text, fmt, &tm) == 0)
+            text[0] = '\0';
+        stats_poll();
+
+        if (resized) {
+            /* laid out again, on a clear screen */
+            sb_set_width(ctx, resize_width());
+            rp_resize(scr);
+            painted = 0;
+        } /* if */
+
+        if (!painted || strcmp(text, old)) {
+            if (clk_render(ctx, text, scr) < 0
+                    || rp_paint(scr, 1) < 0) {
+                fprintf(stderr,
+                        F("%s (errno = %d)\n"),
+                        strerror(errno), errno);
+                break;
+            } /* if */
+            strcpy(old, text);
+            painted = 1;
+        } /* if */
+
+        /* sleep until the next second boundary */
+        now.tv_sec++;
+        now.tv_nsec = 0;
+        while (!stop && !resized && !stats_due
+                && clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME,
+                    &now, NULL) == EINTR)
+            continue;
+    } /* while */
+
+    free_ctx(ctx);
+    rp_free(scr);
+    return stop ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* run_clock */
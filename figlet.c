@@ -0,0 +1,617 @@
+/* figlet.c --- FIGlet fonts, compiled and cached.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 13:42:26 EEST 2026
+ *
+ * sb_font_load() reads a FIGlet font (a .flf file) and compiles it
+ * into an image with its glyphs and the same two level index the
+ * built-in font uses (see font.h), made of offsets and glyph numbers
+ * only, with no pointers, so it is used right where it is mapped.
+ * The image is saved in the cache directory given, and the next
+ * loads of the same font (while the .flf file doesn't change) just
+ * map it in memory, with nothing to parse.
+ *
+ * The glyphs are drawn as they are in the font, at full width (no
+ * kerning or smushing), with the hardblanks as blanks.  Characters
+ * other than ASCII in the glyphs are drawn as '?'.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "font.h"
+#include "sysvbanner.h"
+
+#define SBF_MAGIC   "SBFONT2"
+#define SBF_BOM     0x01020304      /* written in the host byte order */
+#define SBF_ALIGN   8               /* of the parts of the image */
+
+#define FLF_MAXH    255             /* as struct chrinfo can hold */
+#define FLF_MAXW    255
+
+/* the compiled font.  The offsets are from the start of the image,
+ * those of the glyph rows from the start of the rows. */
+struct sbf_header {
+    char        magic[8];
+    uint32_t    bom;
+    uint32_t    size;               /* of the image */
+    uint64_t    src_size;           /* of the .flf file */
+    int64_t     src_mtime, src_mtime_ns;
+    uint32_t    height, max_width;
+    uint32_t    nglyphs, nranges, npages;
+    uint32_t    glyphs, ranges, dir, pages, rows;
+};
+
+struct sbf_range {
+    uint32_t    fst, lst;
+    uint32_t    first;              /* number of the glyph of fst */
+};
+
+/* a glyph read from the .flf file */
+struct flf_glyph {
+    uint32_t    code;
+    size_t      order;              /* in the file */
+    size_t      w;
+    char       *rows;               /* height rows of w chars */
+};
+
+struct flf {
+    const char         *p, *end;    /* what's left to read */
+    int                 hardblank;
+    size_t              height;
+    struct flf_glyph   *g;
+    size_t              n, cap;
+    struct flf_glyph    invalid;    /* code 0, if the font has it */
+};
+
+/* the characters FIGlet fonts have after ASCII, in order */
+static const uint32_t deutsch[] = { 196, 214, 220, 228, 246, 252, 223 };
+
+/* the next line, without its newline, or NULL at the end */
+static const char *
+next_line(
+        struct flf *f,
+        size_t *len)
+{
+    const char *l = f->p, *nl;
+
+    if (f->p >= f->end)
+        return NULL;
+    nl = memchr(f->p, '\n', f->end - f->p);
+    *len = (nl ? nl : f->end) - l;
+    f->p = nl ? nl + 1 : f->end;
+    return l;
+} /* next_line */
+
+/* reads the rows of a glyph.  As FIGlet does, the trailing blanks
+ * and the endmarks (the last character, repeated) are dropped. */
+static int
+read_glyph(
+        struct flf *f,
+        struct flf_glyph *g)
+{
+    const char *line[FLF_MAXH];
+    size_t len[FLF_MAXH], i, j;
+
+    g->w = 0;
+    for (i = 0; i < f->height; i++) {
+        size_t n, cols = 0;
+        const char *l = line[i] = next_line(f, &n);
+
+        if (!l) {
+            errno = EINVAL;
+            return -1;
+        } /* if */
+        while (n && (l[n - 1] == '\r' || l[n - 1] == ' '
+                    || l[n - 1] == '\t'))
+            n--;
+        if (n) {
+            char end = l[n - 1];
+            while (n && l[n - 1] == end)
+                n--;
+        } /* if */
+        len[i] = n;
+        for (j = 0; j < n; j++)
+            cols += ((unsigned char) l[j] & 0xc0) != 0x80;
+        if (g->w < cols)
+            g->w = cols;
+    } /* for */
+    if (g->w > FLF_MAXW)
+        g->w = FLF_MAXW;
+
+    /* all the rows as wide as the widest */
+    if (!(g->rows = malloc(f->height * g->w + 1)))
+        return -1;
+    for (i = 0; i < f->height; i++) {
+        char *r = g->rows + i * g->w;
+        size_t k = 0;
+        for (j = 0; j < len[i] && k < g->w; j++) {
+            unsigned char c = line[i][j];
+            if ((c & 0xc0) == 0x80)     /* rest of a multibyte char */
+                continue;
+            r[k++] = c == f->hardblank || c < ' ' || c == 0x7f
+                ? ' '
+                : c < 0x80 ? c : '?';
+        } /* for */
+        memset(r + k, ' ', g->w - k);
+    } /* for */
+    return 0;
+} /* read_glyph */
+
+static int
+add_glyph(
+        struct flf *f,
+        uint32_t code)
+{
+    struct flf_glyph *g;
+
+    if (f->n == f->cap) {
+        size_t cap = f->cap ? 2 * f->cap : 256;
+        if (!(g = realloc(f->g, cap * sizeof *g)))
+            return -1;
+        f->g = g;
+        f->cap = cap;
+    } /* if */
+    g = &f->g[f->n];
+    g->code = code;
+    g->order = f->n;
+    if (read_glyph(f, g) < 0)
+        return -1;
+    f->n++;
+    return 0;
+} /* add_glyph */
+
+static void
+flf_free(
+        struct flf *f)
+{
+    size_t i;
+
+    for (i = 0; i < f->n; i++)
+        free(f->g[i].rows);
+    free(f->g);
+    free(f->invalid.rows);
+} /* flf_free */
+
+/* reads the glyphs of the font in text[0..len) */
+static int
+parse(
+        struct flf *f,
+        const char *text,
+        size_t len)
+{
+    int height, baseline, maxlen, layout, ncomments;
+    const char *l;
+    size_t n;
+    uint32_t c;
+
+    memset(f, 0, sizeof *f);
+    f->p = text;
+    f->end = text + len;
+
+    /* flf2a$ height baseline max_length old_layout comment_lines ... */
+    if (!(l = next_line(f, &n)) || n < 6 || strncmp(l, "flf2a", 5)
+            || sscanf(l + 6, "%d %d %d %d %d", &height, &baseline,
+                &maxlen, &layout, &ncomments) != 5
+            || height < 1 || height > FLF_MAXH || ncomments < 0) {
+        errno = EINVAL;
+        return -1;
+    } /* if */
+    f->hardblank = (unsigned char) l[5];
+    f->height = height;
+    while (ncomments-- > 0)
+        if (!next_line(f, &n)) {
+            errno = EINVAL;
+            return -1;
+        } /* if */
+
+    /* ASCII and the deutsch characters, in order, and then the code
+     * tagged ones (a line with the code before each) */
+    for (c = ' '; c < 0x7f; c++)
+        if (add_glyph(f, c) < 0)
+            return -1;
+    for (n = 0; n < sizeof deutsch / sizeof deutsch[0] && f->p < f->end;
+            n++)
+        if (add_glyph(f, deutsch[n]) < 0)
+            return -1;
+    while ((l = next_line(f, &n)) != NULL) {
+        char *e;
+        long code = strtol(l, &e, 0);
+
+        if (e == l) {
+            if (strspn(l, " \t\r") == n)
+                continue;       /* a blank line */
+            break;              /* not a code tag, the font ends here */
+        } /* if */
+        if (code == 0) {
+            free(f->invalid.rows);
+            if (read_glyph(f, &f->invalid) < 0)
+                return -1;
+        } else if (code < 0 || code >= IDX_LIMIT) {
+            /* not a code point, skip it */
+            struct flf_glyph skip;
+            if (read_glyph(f, &skip) < 0)
+                return -1;
+            free(skip.rows);
+        } else if (add_glyph(f, code) < 0) {
+            return -1;
+        } /* if */
+    } /* while */
+    return 0;
+} /* parse */
+
+static int
+by_code(
+        const void *a,
+        const void *b)
+{
+    const struct flf_glyph *x = a, *y = b;
+
+    if (x->code != y->code)
+        return x->code < y->code ? -1 : 1;
+    return x->order < y->order ? -1 : x->order > y->order;
+} /* by_code */
+
+#define ALIGN(n) (((n) + SBF_ALIGN - 1) & ~(size_t) (SBF_ALIGN - 1))
+
+/* the image of the font read, built as mkfont builds the tables of
+ * the built-in font: consecutive code points make a range, and each
+ * block of IDX_PGSZ code points with some glyph gets a page of the
+ * index, page 0 being all glyph 0 (the invalid one). */
+static char *
+compile(
+        struct flf *f,
+        const struct stat *st,
+        size_t *len)
+{
+    struct sbf_header *h;
+    struct chrinfo *gl;
+    struct sbf_range *rg;
+    uint16_t *dir;
+    uint32_t (*pages)[IDX_PGSZ];
+    char *image, *rows;
+    size_t i, n, nglyphs, nranges = 0, npages = 1, off;
+    size_t o_glyphs, o_ranges, o_dir, o_pages, o_rows, size;
+    long last_page = -1;
+    size_t max_width = f->invalid.w;
+
+    /* sorted, the first definition of a code point is kept */
+    qsort(f->g, f->n, sizeof *f->g, by_code);
+    for (i = n = 0; i < f->n; i++) {
+        if (n && f->g[n - 1].code == f->g[i].code) {
+            free(f->g[i].rows);
+            continue;
+        } /* if */
+        f->g[n++] = f->g[i];
+    } /* for */
+    f->n = n;
+    for (i = 0; i < f->n; i++) {
+        if (!i || f->g[i].code != f->g[i - 1].code + 1)
+            nranges++;
+        if ((long) (f->g[i].code >> IDX_BITS) != last_page) {
+            last_page = f->g[i].code >> IDX_BITS;
+            npages++;
+        } /* if */
+        if (max_width < f->g[i].w)
+            max_width = f->g[i].w;
+    } /* for */
+    nglyphs = f->n + 1;
+
+    o_glyphs = ALIGN(sizeof *h);
+    o_ranges = ALIGN(o_glyphs + nglyphs * sizeof *gl);
+    o_dir = ALIGN(o_ranges + nranges * sizeof *rg);
+    o_pages = ALIGN(o_dir + IDX_NPAGES * sizeof *dir);
+    o_rows = o_pages + npages * sizeof *pages;
+    size = o_rows + f->height * f->invalid.w;
+    for (i = 0; i < f->n; i++)
+        size += f->height * f->g[i].w;
+    if (size > UINT32_MAX) {
+        errno = EFBIG;
+        return NULL;
+    } /* if */
+    if (!(image = calloc(1, size)))
+        return NULL;
+
+    h = (struct sbf_header *) image;
+    gl = (struct chrinfo *) (image + o_glyphs);
+    rg = (struct sbf_range *) (image + o_ranges);
+    dir = (uint16_t *) (image + o_dir);
+    pages = (uint32_t (*)[IDX_PGSZ]) (image + o_pages);
+    rows = image + o_rows;
+
+    memcpy(h->magic, SBF_MAGIC, sizeof h->magic);
+    h->bom = SBF_BOM;
+    h->size = size;
+    h->src_size = st->st_size;
+    h->src_mtime = st->st_mtim.tv_sec;
+    h->src_mtime_ns = st->st_mtim.tv_nsec;
+    h->height = f->height;
+    h->max_width = max_width;
+    h->nglyphs = nglyphs;
+    h->nranges = nranges;
+    h->npages = npages;
+    h->glyphs = o_glyphs;
+    h->ranges = o_ranges;
+    h->dir = o_dir;
+    h->pages = o_pages;
+    h->rows = o_rows;
+
+    /* glyph 0, the invalid one */
+    gl[0].w = f->invalid.w;
+    gl[0].h = f->invalid.w ? f->height : 0;
+    gl[0].off = 0;
+    memcpy(rows, f->invalid.rows, f->height * f->invalid.w);
+    off = f->height * f->invalid.w;
+
+    nranges = 0;
+    npages = 1;
+    last_page = -1;
+    for (i = 0; i < f->n; i++) {
+        struct flf_glyph *g = &f->g[i];
+        uint32_t c = g->code;
+
+        gl[i + 1].w = g->w;
+        gl[i + 1].h = f->height;
+        gl[i + 1].off = off;
+        memcpy(rows + off, g->rows, f->height * g->w);
+        off += f->height * g->w;
+
+        if (!i || c != f->g[i - 1].code + 1) {
+            rg[nranges].fst = c;
+            rg[nranges].first = i + 1;
+            nranges++;
+        } /* if */
+        rg[nranges - 1].lst = c;
+
+        if ((long) (c >> IDX_BITS) != last_page) {
+            last_page = c >> IDX_BITS;
+            dir[last_page] = npages++;
+        } /* if */
+        pages[dir[c >> IDX_BITS]][c & IDX_MASK] = i + 1;
+    } /* for */
+    *len = size;
+    return image;
+} /* compile */
+
+/* the font in the image, checked, as it may come from a file */
+static struct sb_font *
+open_image(
+        char *image,
+        size_t len,
+        int mapped)
+{
+    const struct sbf_header *h = (const struct sbf_header *) image;
+    const struct chrinfo *gl;
+    struct sb_font *f;
+    size_t i, j, rows_len;
+
+    if (len < sizeof *h || memcmp(h->magic, SBF_MAGIC, sizeof h->magic)
+            || h->bom != SBF_BOM || h->size != len
+            || h->height < 1 || h->height > FLF_MAXH
+            || h->max_width > FLF_MAXW || h->nglyphs < 1
+            || h->npages < 1 || h->npages > IDX_NPAGES + 1
+            || h->glyphs % SBF_ALIGN || h->dir % SBF_ALIGN
+            || h->pages % SBF_ALIGN
+            || h->glyphs + (uint64_t) h->nglyphs * sizeof *gl > len
+            || h->ranges + (uint64_t) h->nranges
+                * sizeof (struct sbf_range) > len
+            || h->dir + (uint64_t) IDX_NPAGES * sizeof (uint16_t) > len
+            || h->pages + (uint64_t) h->npages
+                * IDX_PGSZ * sizeof (uint32_t) > len
+            || h->rows > len)
+        goto bad;
+    rows_len = len - h->rows;
+
+    if (!(f = calloc(1, sizeof *f)))
+        return NULL;
+    f->dir = (const uint16_t *) (image + h->dir);
+    f->pages = (const uint32_t (*)[IDX_PGSZ]) (image + h->pages);
+    for (i = 0; i < IDX_NPAGES; i++)
+        if (f->dir[i] >= h->npages)
+            goto bad_font;
+    for (i = 0; i < h->npages; i++)
+        for (j = 0; j < IDX_PGSZ; j++)
+            if (f->pages[i][j] >= h->nglyphs)
+                goto bad_font;
+
+    gl = (const struct chrinfo *) (image + h->glyphs);
+    for (i = 0; i < h->nglyphs; i++)
+        if (gl[i].w > h->max_width || gl[i].h > h->height
+                || gl[i].off + (uint64_t) gl[i].w * gl[i].h > rows_len)
+            goto bad_font;
+    f->glyphs = gl;
+    f->rows = image + h->rows;
+    f->height = h->height;
+    f->max_width = h->max_width;
+    f->nglyphs = h->nglyphs;
+    f->image = image;
+    f->image_len = len;
+    f->mapped = mapped;
+    return f;
+
+bad_font:
+    free(f);
+bad:
+    errno = EINVAL;
+    return NULL;
+} /* open_image */
+
+/* the name of the compiled font in the cache: the name of the font
+ * and a hash of its full path */
+static char *
+cache_name(
+        const char *cache,
+        const char *path)
+{
+    char *real = realpath(path, NULL), *name = NULL;
+    const char *base, *p;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t n, len;
+
+    if (!real)
+        return NULL;
+    for (p = real; *p; p++) {   /* FNV-1a */
+        hash ^= (unsigned char) *p;
+        hash *= 0x100000001b3ULL;
+    } /* for */
+    base = strrchr(real, '/') + 1;
+    n = strlen(base);
+    if (n > 4 && !strcmp(base + n - 4, ".flf"))
+        n -= 4;
+    len = snprintf(NULL, 0, "%s/%.*s-%016llx.sbf",
+            cache, (int) n, base, (unsigned long long) hash) + 1;
+    if ((name = malloc(len)) != NULL)
+        snprintf(name, len, "%s/%.*s-%016llx.sbf",
+                cache, (int) n, base, (unsigned long long) hash);
+    free(real);
+    return name;
+} /* cache_name */
+
+/* the compiled font, if it's in the cache and up to date */
+static struct sb_font *
+load_cached(
+        const char *name,
+        const struct stat *src)
+{
+    const struct sbf_header *h;
+    struct sb_font *f;
+    struct stat st;
+    char *image;
+    int fd = open(name, O_RDONLY);
+
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t) sizeof *h) {
+        close(fd);
+        return NULL;
+    } /* if */
+    image = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED)
+        return NULL;
+    h = (const struct sbf_header *) image;
+    if (h->src_size != (uint64_t) src->st_size
+            || h->src_mtime != src->st_mtim.tv_sec
+            || h->src_mtime_ns != src->st_mtim.tv_nsec
+            || !(f = open_image(image, st.st_size, 1))) {
+        munmap(image, st.st_size);
+        return NULL;
+    } /* if */
+    return f;
+} /* load_cached */
+
+/* saves the compiled font, atomically, as others may be mapping it.
+ * Failing to save it is not an error, it will be compiled again. */
+static void
+save_cached(
+        const char *name,
+        const char *image,
+        size_t len)
+{
+    static const char sfx[] = ".XXXXXX";
+    size_t n = strlen(name);
+    char *tmp = malloc(n + sizeof sfx);
+    int fd;
+
+    if (!tmp)
+        return;
+    memcpy(tmp, name, n);
+    memcpy(tmp + n, sfx, sizeof sfx);
+    if ((fd = mkstemp(tmp)) < 0) {
+        free(tmp);
+        return;
+    } /* if */
+    if (sb_sink_fd(&fd, image, len) < 0 || fchmod(fd, 0644) < 0
+            || close(fd) < 0 || rename(tmp, name) < 0)
+        unlink(tmp);
+    free(tmp);
+} /* save_cached */
+
+/* the whole file, NUL terminated */
+static char *
+read_file(
+        const char *path,
+        size_t *len)
+{
+    char *p = NULL;
+    size_t cap = 0;
+    int fd = open(path, O_RDONLY);
+
+    *len = 0;
+    if (fd < 0)
+        return NULL;
+    for (;;) {
+        ssize_t n;
+        if (*len + 1 >= cap) {
+            char *q = realloc(p, cap = cap ? 2 * cap : 65536);
+            if (!q) break;
+            p = q;
+        } /* if */
+        n = read(fd, p + *len, cap - *len - 1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) break;
+        if (n == 0) {
+            close(fd);
+            p[*len] = '\0';
+            return p;
+        } /* if */
+        *len += n;
+    } /* for */
+    free(p);
+    close(fd);
+    return NULL;
+} /* read_file */
+
+struct sb_font *
+sb_font_load(
+        const char *path,
+        const char *cache)
+{
+    struct sb_font *font = NULL;
+    struct stat st;
+    struct flf flf;
+    char *name = NULL, *text, *image;
+    size_t len;
+
+    if (stat(path, &st) < 0)
+        return NULL;
+    if (cache && (name = cache_name(cache, path)) != NULL
+            && (font = load_cached(name, &st)) != NULL) {
+        free(name);
+        return font;
+    } /* if */
+
+    if ((text = read_file(path, &len)) != NULL) {
+        image = parse(&flf, text, len) < 0
+            ? NULL
+            : compile(&flf, &st, &len);
+        flf_free(&flf);
+        free(text);
+        if (image) {
+            if (name)
+                save_cached(name, image, len);
+            if (!(font = open_image(image, len, 0)))
+                free(image);
+        } /* if */
+    } /* if */
+    free(name);
+    return font;
+} /* sb_font_load */
+
+void
+sb_font_free(
+        struct sb_font *f)
+{
+    if (!f) return;
+    if (f->mapped)
+        munmap(f->image, f->image_len);
+    else
+        free(f->image);
+    free(f);
+} /* sb_font_free */
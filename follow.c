@@ -0,0 +1,299 @@
+/* follow.c --- banners of the lines appended to files, as tail -F.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 14:21:36 EEST 2026
+ *
+ * sysvbanner --follow file ... waits for lines to be appended to the
+ * files and renders each one as soon as it's complete, written at
+ * once to the output, without going through a pipe (and its
+ * buffering) from tail(1).  The files are read from their end, as
+ * they were when the program started, and followed by name: a file
+ * truncated is read again from its start, and one renamed or removed
+ * (log rotation) is read up to its end and then replaced by the new
+ * file of the same name, when it appears.  All the lines go to the
+ * same banner, so a frame (-f) goes on from line to line, and it's
+ * closed when the program is stopped (SIGINT, SIGTERM).
+ *
+ * The wait is done with inotify(7) on the directories of the files,
+ * which tells about the writes to the files and the names created,
+ * renamed and removed in them, and every few hundred milliseconds
+ * anyway, for the files in directories that can't be watched (and
+ * on the systems without inotify).
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "banner.h"
+
+#define FW_POLL_MS      250         /* the longest wait for a change */
+#define FW_READ         (64 * 1024) /* bytes read at once */
+
+struct followed {
+    const char     *path;
+    int             fd;         /* -1 while it doesn't exist */
+    dev_t           dev;        /* of the file open, to tell when */
+    ino_t           ino;        /* the name gets another one */
+    off_t           off;        /* read up to here */
+    char           *buf;        /* the last line, not complete yet */
+    size_t          len, cap;
+    int             missing;    /* already reported */
+};
+
+static volatile sig_atomic_t stop;
+static struct sb_ctx *ctx;
+static int out;
+
+static void
+on_signal(
+        int sig)
+{
+    stop = 1;
+} /* on_signal */
+
+static void
+fw_render(
+        const char *s,
+        size_t len)
+{
+    if (resized)
+        sb_set_width(ctx, resize_width());
+    if (sb_render_utf8(ctx, s, len, sb_sink_fd, &out) < 0) {
+        fprintf(stderr,
+                F("sb_render: %s (errno = %d)\n"),
+                strerror(errno), errno);
+        exit(EXIT_FAILURE);
+    } /* if */
+    stats_poll();
+} /* fw_render */
+
+/* opens the file, positioned at its end or at its start */
+static int
+fw_open(
+        struct followed *f,
+        int at_end)
+{
+    struct stat st;
+
+    f->fd = open(f->path, O_RDONLY | O_CLOEXEC);
+    if (f->fd < 0 || fstat(f->fd, &st) < 0) {
+        if (!f->missing)
+            fprintf(stderr,
+                    F("%s: %s (errno = %d), waiting for it\n"),
+                    f->path, strerror(errno), errno);
+        if (f->fd >= 0)
+            close(f->fd);
+        f->fd = -1;
+        f->missing = 1;
+        return -1;
+    } /* if */
+    f->missing = 0;
+    f->dev = st.st_dev;
+    f->ino = st.st_ino;
+    f->off = at_end ? lseek(f->fd, 0, SEEK_END) : 0;
+    if (f->off < 0)
+        f->off = 0;
+    f->len = 0;
+    return 0;
+} /* fw_open */
+
+/* reads the file up to its end, rendering the complete lines */
+static void
+fw_read(
+        struct followed *f)
+{
+    for (;;) {
+        char *p, *q, *nl;
+        ssize_t n;
+
+        if (f->cap - f->len < FW_READ) {
+            size_t cap = f->cap ? f->cap : FW_READ;
+            char *b;
+            while (cap - f->len < FW_READ) cap <<= 1;
+            if (!(b = realloc(f->buf, cap))) {
+                fprintf(stderr,
+                        F("realloc: %s (errno = %d)\n"),
+                        strerror(errno), errno);
+                exit(EXIT_FAILURE);
+            } /* if */
+            f->buf = b;
+            f->cap = cap;
+        } /* if */
+        n = read(f->fd, f->buf + f->len, f->cap - f->len);
+        if (n < 0 && errno == EINTR) {
+            if (stop) return;
+            continue;
+        } /* if */
+        if (n < 0) {
+            fprintf(stderr,
+                    F("read: %s: %s (errno = %d)\n"),
+                    f->path, strerror(errno), errno);
+            return;
+        } /* if */
+        if (n == 0)
+            return;
+        f->off += n;
+
+        /* only the complete lines, the rest waits for its newline
+         * (what was kept has none, only the bytes read are looked at) */
+        for (p = f->buf, q = f->buf + f->len;
+                (nl = memchr(q, '\n', f->buf + f->len + n - q)) != NULL;
+                p = q = nl + 1)
+            fw_render(p, nl - p);
+        f->len += n;
+        memmove(f->buf, p, f->len -= p - f->buf);
+    } /* for */
+} /* fw_read */
+
+/* reads what was appended to the file, and checks whether it was
+ * truncated or its name now belongs to another file */
+static void
+fw_check(
+        struct followed *f)
+{
+    struct stat st;
+
+    if (f->fd >= 0) {
+        fw_read(f);
+        if (fstat(f->fd, &st) == 0 && st.st_size < f->off) {
+            /* truncated, the line begun is lost */
+            f->off = lseek(f->fd, 0, SEEK_SET);
+            f->len = 0;
+            fw_read(f);
+        } /* if */
+    } /* if */
+    if (stat(f->path, &st) < 0
+            || (f->fd >= 0 && st.st_dev == f->dev && st.st_ino == f->ino))
+        return;
+
+    /* rotated: the old file is over (its last line too, even without
+     * newline), and the new one is read from its start */
+    if (f->fd >= 0) {
+        if (f->len)
+            fw_render(f->buf, f->len);
+        close(f->fd);
+    } /* if */
+    if (fw_open(f, 0) == 0)
+        fw_read(f);
+} /* fw_check */
+
+/* the inotify(7) descriptor, watching the directories of the files,
+ * or -1 */
+static int
+fw_watch(
+        struct followed *fs,
+        int n)
+{
+    int fd = -1;
+#ifdef __linux__
+    int i;
+
+    if ((fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0)
+        return -1;
+    for (i = 0; i < n; i++) {
+        const char *slash = strrchr(fs[i].path, '/');
+        char dir[PATH_MAX];
+
+        if (!slash)
+            strcpy(dir, ".");
+        else if (slash == fs[i].path)
+            strcpy(dir, "/");
+        else
+            snprintf(dir, sizeof dir, "%.*s",
+                    (int) (slash - fs[i].path), fs[i].path);
+        /* the same directory gives the same watch */
+        if (inotify_add_watch(fd, dir, IN_MODIFY | IN_ATTRIB
+                    | IN_CREATE | IN_DELETE | IN_MOVED_FROM
+                    | IN_MOVED_TO) < 0)
+            fprintf(stderr,
+                    F("inotify_add_watch: %s: %s (errno = %d)\n"),
+                    dir, strerror(errno), errno);
+    } /* for */
+#endif
+    return fd;
+} /* fw_watch */
+
+/* waits for a change in the directories watched, a signal or
+ * FW_POLL_MS */
+static void
+fw_wait(
+        int wfd)
+{
+    struct pollfd p;
+
+    p.fd = wfd;
+    p.events = POLLIN;
+    if (poll(&p, wfd >= 0, FW_POLL_MS) > 0) {
+        /* what changed doesn't matter, all the files are checked */
+        char ev[4096];
+        while (read(wfd, ev, sizeof ev) > 0)
+            continue;
+    } /* if */
+} /* fw_wait */
+
+int
+run_follow(
+        char **names,
+        int nnames,
+        int fd)
+{
+    struct followed *fs = calloc(nnames, sizeof *fs);
+    struct sigaction sa;
+    int i, wfd;
+
+    out = fd;
+    ctx = new_ctx(flags & FLAG_SB_MASK);
+    if (!ctx || !fs) {
+        fprintf(stderr,
+                F("run_follow: %s (errno = %d)\n"),
+                strerror(errno), errno);
+        return EXIT_FAILURE;
+    } /* if */
+
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    watch_resize();
+
+    for (i = 0; i < nnames; i++) {
+        fs[i].path = names[i];
+        fw_open(&fs[i], 1);
+    } /* for */
+    wfd = fw_watch(fs, nnames);
+
+    while (!stop) {
+        for (i = 0; i < nnames && !stop; i++)
+            fw_check(&fs[i]);
+        stats_poll();
+        if (!stop)
+            fw_wait(wfd);
+    } /* while */
+
+    if (sb_close(ctx, sb_sink_fd, &out) < 0) {
+        fprintf(stderr,
+                F("sb_close: %s (errno = %d)\n"),
+                strerror(errno), errno);
+        return EXIT_FAILURE;
+    } /* if */
+    for (i = 0; i < nnames; i++) {
+        if (fs[i].fd >= 0)
+            close(fs[i].fd);
+        free(fs[i].buf);
+    } /* for */
+    free(fs);
+    if (wfd >= 0)
+        close(wfd);
+    free_ctx(ctx);
+    return EXIT_SUCCESS;
+} /* run_follow */
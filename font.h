@@ -0,0 +1,105 @@
+/* font.h --- constant font tables for sysvbanner.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 04:30:12 EEST 2026
+ *
+ * The tables declared here are generated at build time by mkfont
+ * (see mkfont.c and glyphs.h) into font.c, so they are measured
+ * once and can live in read only memory.  They hold no pointers,
+ * only offsets and glyph numbers, so they need no relocations when
+ * the program is loaded and their pages are shared by all the
+ * processes running it.
+ */
+#ifndef _FONT_H
+#define _FONT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <wchar.h>
+
+#include "bitmap.h"
+
+/* w and h are the glyph's width and height, the glyph rows are
+ * packed (see bitmap.h), starting at bitmaps[off], and drawn with
+ * the ink character.  The glyphs of the fonts loaded (see figlet.c)
+ * are text instead, their h rows of w characters each, one after
+ * the other, start at offset off of the rows of the font. */
+struct chrinfo {
+    unsigned char w, h;
+    char ink;
+    unsigned char unused;
+    uint32_t off;
+};
+
+/* ranges of code points covered by the font, both ends included,
+ * and the number in glyphs[] of the glyph of fst (the glyphs of a
+ * range are consecutive) */
+struct range {
+    wchar_t fst;
+    wchar_t lst;
+    unsigned first;
+};
+
+/* two level index over the whole unicode range, built from ranges[].
+ * idx_dir[] gives, for each block of IDX_PGSZ code points, the page
+ * of idx_page[] to use, which has the numbers of the glyphs in
+ * glyphs[].  Glyph 0 is the one drawn for the code points not in the
+ * font, page IDX_NONE has all its entries set to it and is shared by
+ * all the blocks the font doesn't cover, page IDX_HOT is the ASCII
+ * and Latin-1 block, so a lookup is always two array accesses. */
+#define IDX_BITS    8
+#define IDX_PGSZ    (1 << IDX_BITS)
+#define IDX_MASK    (IDX_PGSZ - 1)
+#define IDX_LIMIT   0x110000
+#define IDX_NPAGES  (IDX_LIMIT >> IDX_BITS)
+#define IDX_NONE    0
+#define IDX_HOT     1
+
+extern const bm_row bitmaps[];
+extern const struct chrinfo glyphs[];
+extern const struct range ranges[];
+extern const int nranges;
+extern const int nglyphs;
+extern const int max_width;
+
+extern const unsigned short idx_page[][IDX_PGSZ];
+extern const unsigned short idx_dir[IDX_NPAGES];
+
+static inline const struct chrinfo *
+getchrinfo(
+        wchar_t c)
+{
+    if ((unsigned long) c < IDX_PGSZ)
+        return glyphs + idx_page[IDX_HOT][c];
+    if ((unsigned long) c >= IDX_LIMIT)
+        return glyphs;
+    return glyphs + idx_page[idx_dir[c >> IDX_BITS]][c & IDX_MASK];
+} /* getchrinfo */
+
+/* a font loaded with sb_font_load() (see figlet.c).  All of it
+ * (glyphs, index and rows) lives in its compiled image, usually a
+ * file mapped in memory, indexed as the built-in font: page
+ * dir[c >> IDX_BITS] of pages[] has the number of the glyph of c,
+ * glyphs[0] being drawn for the code points not in the font. */
+struct sb_font {
+    const struct chrinfo   *glyphs;
+    const uint16_t         *dir;
+    const uint32_t        (*pages)[IDX_PGSZ];
+    const char             *rows;
+    int                     nglyphs;
+    int                     height, max_width;
+    char                   *image;      /* the compiled font */
+    size_t                  image_len;
+    int                     mapped;     /* image is a file mapping */
+};
+
+static inline const struct chrinfo *
+font_glyph(
+        const struct sb_font *f,
+        wchar_t c)
+{
+    if ((unsigned long) c >= IDX_LIMIT)
+        return f->glyphs;
+    return f->glyphs + f->pages[f->dir[c >> IDX_BITS]][c & IDX_MASK];
+} /* font_glyph */
+
+#endif /* _FONT_H */
@@ -0,0 +1,1826 @@
+/* libsysvbanner.c --- reentrant banner rendering library.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 05:31:07 EEST 2026
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#include "font.h"
+#include "sysvbanner.h"
+#include "utf8.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/* banner lines bigger than this are handed to the sink in chunks of
+ * about this size (whole rows with SB_ROWS), so very long lines don't
+ * need an output buffer as big as their banner */
+#define SB_CHUNK    (64 * 1024)
+
+/* the iovecs handed to writev(2) at once, and the shortest piece of
+ * output pointed at by one instead of copied, see rows_iov() */
+#ifndef IOV_MAX
+#define IOV_MAX     1024
+#endif
+#define IOV_REF     256
+
+/* output buffer, a whole banner line (frame included) is composed
+ * here and then handed to the sink at once.  err is sticky, once an
+ * allocation fails, nothing else is added. */
+struct outbuf {
+    char   *b;
+    size_t  len, cap;
+    int     err;
+};
+
+/* composes the glyph rows of a line, see DEF_ROWS() */
+typedef ssize_t rows_fn(struct sb_ctx *ctx, int h, size_t row_l,
+        int chunked, sb_sink *sink, void *arg);
+
+struct sb_ctx {
+    int                     flags;
+    int                     enc;        /* SB_ENC_* */
+    long                    lineno;     /* lines rendered */
+    size_t                  last_l;     /* width of the last line */
+    const struct chrinfo  **cis;        /* glyphs of the line */
+    size_t                  cis_len, cis_cap;
+    size_t                  rows;       /* glyph rows of the line */
+    size_t                  cols;       /* wrap width, 0 for none */
+    size_t                 *psum;       /* see layout() */
+    size_t                  psum_len, psum_cap;
+    size_t                  seg;        /* first glyph of the last
+                                         * banner line of the text */
+    int                     part;       /* a line being given in parts,
+                                         * see sb_render_part() */
+    long                    part_lines; /* its banner lines composed */
+    char                    carry[4];   /* UTF-8 sequence cut at the
+                                         * end of the last part */
+    size_t                  carry_len;
+    mbstate_t               mbst;       /* of the locale decoding */
+    size_t                 *col;        /* see sb_geometry() */
+    size_t                  col_cap;
+    struct outbuf           out;
+
+    /* the font, see sb_set_font() */
+    const struct sb_font   *font;       /* NULL for the built-in one */
+    const char             *text;       /* its rows, NULL for bitmaps */
+    const struct chrinfo   *hot[IDX_PGSZ];  /* glyphs of the first page */
+    const struct chrinfo   *invalid;    /* for what's not in the font */
+    int                     height;     /* of the lines, at least */
+    int                     max_h;      /* the tallest glyph */
+    size_t                  max_w;      /* the widest glyph */
+    size_t                  gap;        /* between glyphs */
+    const struct chrinfo   *glyphs;     /* all of them, by number */
+    int                     nglyphs;
+
+    /* scaling, see sb_set_scale() */
+    int                     sx, sy;
+
+    /* the renderers of the glyph rows, for lines with glyphs and for
+     * empty ones (no frame), and the frame characters, chosen by the
+     * flags, see sb_new() */
+    rows_fn                *draw_rows, *draw_bare;
+    const struct frame     *frm;
+
+    /* the glyphs ready to be copied, see make_atlas() */
+    char                   *atlas;
+    size_t                 *atlas_off;
+    unsigned char          *atlas_done;
+
+    /* the pieces of output to be written, see rows_iov() */
+    struct iovec           *iov;
+    int                     niov;
+    int                     iov_cut;    /* not to be extended below */
+    unsigned long           iov_gen;    /* writes done */
+
+    /* styling, see sb_set_style() */
+    int                     fill;       /* replaces the '#' ink */
+    int                     color;      /* SB_COLOR_* */
+    int                     styled;     /* colors must be output */
+    char                  **sgr;        /* escape sequences, SGR_* */
+    size_t                  n_sgr;
+    int                     cur;        /* SGR in effect, or SGR_NONE */
+
+    /* statistics, see sb_set_stats() */
+    int                     stats;      /* kept */
+    struct sb_stats         st;
+    unsigned long           st_bytes;   /* all the output */
+};
+
+/* indexes in ctx->sgr[], the palette starts at SGR_PALETTE */
+#define SGR_NONE    (-1)
+#define SGR_FRAME   0
+#define SGR_INK     1
+#define SGR_PALETTE 2
+
+/* the glyph of c in the font of the context */
+#define GLYPH(ctx, c) ((ctx)->font \
+        ? font_glyph((ctx)->font, (c)) \
+        : getchrinfo(c))
+
+/* write(2) calls of sb_sink_fd(), for all the contexts */
+static atomic_ulong n_writes;
+
+/* the time spent in each phase is only taken with statistics on */
+static unsigned long long
+now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+} /* now_ns */
+
+#define ST_START(ctx)   ((ctx)->stats ? now_ns() : 0)
+#define ST_ADD(ctx, field, t0) do { \
+        if ((ctx)->stats) (ctx)->st.field += now_ns() - (t0); \
+    } while (0)
+
+/* the characters of a frame, ASCII or box drawing, the horizontal
+ * line characters taking cw bytes each */
+struct frame {
+    const char *top_l, *top_r;      /* over the first line */
+    const char *mid_l, *mid_r;      /* between lines as wide */
+    const char *bot_l, *bot_r;      /* under the last line */
+    const char *down, *down_end;    /* to a narrower line */
+    const char *up, *up_end;        /* to a wider line */
+    const char *lft, *rgt;          /* of the glyph rows */
+    const char *line;               /* a run of line characters */
+    size_t      line_l;
+    int         cw;
+};
+
+static const struct frame frame_ascii = {
+    ",=", "=.\n",
+    ">=", "=<\n",
+    "`=", "='\n",
+    "v", "'\n",
+    "^", ".\n",
+    "| ", " |\n",
+    "============================================================",
+    60, 1,
+};
+
+static const struct frame frame_utf = {
+    "\u2552\u2550", "\u2550\u2555\n",
+    "\u255e\u2550", "\u2550\u2561\n",
+    "\u2558\u2550", "\u2550\u255b\n",
+    "\u2564", "\u255b\n",
+    "\u2567", "\u2555\n",
+    "\u2502 ", " \u2502\n",
+    "\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550"
+    "\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550"
+    "\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550"
+    "\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550\u2550",
+    120, 3,
+};
+
+static int ob_reserve(struct outbuf *o, size_t n);
+static void ob_add(struct outbuf *o, const char *s, size_t n);
+static void ob_fill(struct outbuf *o, int c, size_t n);
+static void choose_rows(struct sb_ctx *ctx);
+static void hor_line(struct sb_ctx *ctx, size_t l,
+        const char *lft, const char *rgt);
+static void set_color(struct sb_ctx *ctx, int c);
+static ssize_t rows_iov(struct sb_ctx *ctx, int h, size_t row_l, int fd);
+static ssize_t styled_rows(struct sb_ctx *ctx, int h, size_t this_l,
+        const char *frm_lft, const char *frm_rgt, int chunked,
+        sb_sink *sink, void *arg);
+
+struct sb_ctx *
+sb_new(
+        int flags)
+{
+    struct sb_ctx *ctx = calloc(1, sizeof *ctx);
+
+    if (ctx) {
+        ctx->flags = flags;
+        ctx->enc = SB_ENC_UTF8;
+        ctx->cur = SGR_NONE;
+        ctx->sx = ctx->sy = 1;
+        choose_rows(ctx);
+        sb_set_font(ctx, NULL);
+    } /* if */
+    return ctx;
+} /* sb_new */
+
+/* forgets the glyph atlas, after a change in how the glyphs look */
+static void
+drop_atlas(
+        struct sb_ctx *ctx)
+{
+    free(ctx->atlas);
+    free(ctx->atlas_off);
+    free(ctx->atlas_done);
+    ctx->atlas = NULL;
+    ctx->atlas_off = NULL;
+    ctx->atlas_done = NULL;
+} /* drop_atlas */
+
+void
+sb_free(
+        struct sb_ctx *ctx)
+{
+    if (!ctx) return;
+    drop_atlas(ctx);
+    free(ctx->cis);
+    free(ctx->col);
+    free(ctx->psum);
+    free(ctx->out.b);
+    free(ctx->iov);
+    while (ctx->n_sgr--)
+        free(ctx->sgr[ctx->n_sgr]);
+    free(ctx->sgr);
+    free(ctx);
+} /* sb_free */
+
+int
+sb_set_encoding(
+        struct sb_ctx *ctx,
+        int enc)
+{
+    if (enc != SB_ENC_UTF8 && enc != SB_ENC_LATIN1 && enc != SB_ENC_LOCALE) {
+        errno = EINVAL;
+        return -1;
+    } /* if */
+    ctx->enc = enc;
+    return 0;
+} /* sb_set_encoding */
+
+void
+sb_set_width(
+        struct sb_ctx *ctx,
+        size_t cols)
+{
+    ctx->cols = cols;
+} /* sb_set_width */
+
+void
+sb_set_font(
+        struct sb_ctx *ctx,
+        const struct sb_font *f)
+{
+    int i;
+
+    drop_atlas(ctx);
+    ctx->font = f;
+    if (f) {
+        ctx->glyphs = f->glyphs;
+        ctx->nglyphs = f->nglyphs;
+        ctx->text = f->rows;
+        ctx->invalid = f->glyphs;
+        ctx->height = ctx->max_h = f->height;
+        ctx->max_w = f->max_width;
+        ctx->gap = 0;
+    } else {
+        ctx->glyphs = glyphs;
+        ctx->nglyphs = nglyphs;
+        ctx->text = NULL;
+        ctx->invalid = glyphs;
+        ctx->height = ctx->max_h = 7;
+        ctx->max_w = max_width;
+        ctx->gap = 2;
+        for (i = 0; i < nglyphs; i++)
+            if (ctx->max_h < glyphs[i].h)
+                ctx->max_h = glyphs[i].h;
+    } /* if */
+    for (i = 0; i < IDX_PGSZ; i++)
+        ctx->hot[i] = GLYPH(ctx, i);
+    ctx->cis_len = ctx->psum_len = ctx->seg = 0;
+} /* sb_set_font */
+
+int
+sb_set_scale(
+        struct sb_ctx *ctx,
+        int sx,
+        int sy)
+{
+    if (sx < 1 || sy < 1) {
+        errno = EINVAL;
+        return -1;
+    } /* if */
+    drop_atlas(ctx);
+    ctx->sx = sx;
+    ctx->sy = sy;
+    ctx->psum_len = 0;
+    return 0;
+} /* sb_set_scale */
+
+void
+sb_set_stats(
+        struct sb_ctx *ctx,
+        int on)
+{
+    ctx->stats = on;
+} /* sb_set_stats */
+
+void
+sb_get_stats(
+        const struct sb_ctx *ctx,
+        struct sb_stats *st)
+{
+    *st = ctx->st;
+    st->row_bytes = ctx->st_bytes - ctx->st.frame_bytes;
+} /* sb_get_stats */
+
+void
+sb_add_stats(
+        struct sb_ctx *ctx,
+        const struct sb_stats *st)
+{
+    int i;
+
+    if (!ctx->stats)
+        return;
+    ctx->st.lines += st->lines;
+    ctx->st.glyphs += st->glyphs;
+    for (i = 0; i < SB_NRANGES; i++)
+        ctx->st.range[i] += st->range[i];
+    ctx->st.invalid += st->invalid;
+    ctx->st.frame_bytes += st->frame_bytes;
+    ctx->st_bytes += st->row_bytes + st->frame_bytes;
+    ctx->st.sinks += st->sinks;
+    ctx->st.t_decode += st->t_decode;
+    ctx->st.t_measure += st->t_measure;
+    ctx->st.t_compose += st->t_compose;
+    ctx->st.t_output += st->t_output;
+} /* sb_add_stats */
+
+int
+sb_range(
+        int i,
+        unsigned long *fst,
+        unsigned long *lst)
+{
+    if (i < 0 || i >= SB_NRANGES || i >= nranges)
+        return -1;
+    *fst = ranges[i].fst;
+    *lst = ranges[i].lst;
+    return 0;
+} /* sb_range */
+
+size_t
+sb_estimate(
+        const struct sb_ctx *ctx,
+        size_t len)
+{
+    /* no more glyphs than bytes, and (wrapping) no more banner lines
+     * than glyphs.  Each row of a banner line has its glyph cells and
+     * the frame sides, and the frame lines before and after it take
+     * up to three rows of box characters, three bytes a column. */
+    size_t rows = (size_t) ctx->max_h * ctx->sy + 9,
+           cell = (ctx->gap + ctx->max_w) * ctx->sx,
+           lines = ctx->cols && len ? len : 1,
+           edge = 16, sgr = 0, i;
+
+    if (ctx->styled) {
+        /* a color change for each glyph, and for each color of the
+         * palette (the gradient) in each row */
+        for (i = 0; i < ctx->n_sgr; i++)
+            if (ctx->sgr[i] && sgr < strlen(ctx->sgr[i]))
+                sgr = strlen(ctx->sgr[i]);
+        sgr += sizeof "\033[m";
+        cell += sgr;
+        edge += (ctx->n_sgr + 2) * sgr;
+    } /* if */
+    return rows * (len * cell + lines * edge);
+} /* sb_estimate */
+
+unsigned long
+sb_writes(void)
+{
+    return atomic_load_explicit(&n_writes, memory_order_relaxed);
+} /* sb_writes */
+
+/* counts the glyphs decoded, from the one at i, by range of the
+ * built-in font */
+static void
+count_glyphs(
+        struct sb_ctx *ctx,
+        size_t i)
+{
+    int r;
+
+    ctx->st.glyphs += ctx->cis_len - i;
+    for (; i < ctx->cis_len; i++) {
+        unsigned g;
+        if (ctx->cis[i] == ctx->invalid)
+            ctx->st.invalid++;
+        /* the glyphs of a loaded font are not in glyphs[] */
+        if (ctx->font)
+            continue;
+        g = ctx->cis[i] - glyphs;
+        for (r = 0; r < SB_NRANGES && r < nranges; r++) {
+            if (g - ranges[r].first
+                    <= (unsigned) (ranges[r].lst - ranges[r].fst)) {
+                ctx->st.range[r]++;
+                break;
+            } /* if */
+        } /* for */
+    } /* for */
+} /* count_glyphs */
+
+int
+sb_flags(
+        const struct sb_ctx *ctx)
+{
+    return ctx->flags;
+} /* sb_flags */
+
+static int
+cis_reserve(
+        struct sb_ctx *ctx,
+        size_t n)
+{
+    if (ctx->cis_cap < n) {
+        size_t cap = n + 64;
+        const struct chrinfo **p = realloc(ctx->cis, cap * sizeof *p);
+        if (!p) return -1;
+        ctx->cis = p;
+        ctx->cis_cap = cap;
+    } /* if */
+    return 0;
+} /* cis_reserve */
+
+/* hands the output buffer to the sink, and empties it */
+static ssize_t
+emit(
+        struct sb_ctx *ctx,
+        sb_sink *sink,
+        void *arg)
+{
+    struct outbuf *o = &ctx->out;
+    ssize_t res = o->len;
+    unsigned long long t0 = ST_START(ctx);
+    unsigned long calls = 0;
+
+    if (o->err) {
+        o->len = 0; o->err = 0;
+        errno = ENOMEM;
+        return -1;
+    } /* if */
+
+    if (ctx->flags & SB_ROWS) {
+        char *p = o->b, *end = o->b + o->len;
+        while (p < end) {
+            char *nl = memchr(p, '\n', end - p);
+            size_t n = nl ? nl - p + 1 : end - p;
+            calls++;
+            if (sink(arg, p, n) < 0) {
+                res = -1;
+                break;
+            } /* if */
+            p += n;
+        } /* while */
+    } else if (o->len) {
+        calls++;
+        if (sink(arg, o->b, o->len) < 0)
+            res = -1;
+    } /* if */
+    if (ctx->stats) {
+        ctx->st_bytes += o->len;
+        ctx->st.sinks += calls;
+        ctx->st.t_output += now_ns() - t0;
+    } /* if */
+    o->len = 0;
+    return res;
+} /* emit */
+
+/* in chunked mode, hands what has been composed to the sink once
+ * it reaches SB_CHUNK bytes.  Sinks of SB_ROWS contexts want whole
+ * rows, so for them this is only done at the end of a row (eol).
+ * The bytes sent are added to *total. */
+static int
+flush_chunk(
+        struct sb_ctx *ctx,
+        sb_sink *sink,
+        void *arg,
+        ssize_t *total,
+        int eol)
+{
+    ssize_t n;
+
+    if (ctx->out.len < SB_CHUNK || (ctx->flags & SB_ROWS && !eol))
+        return 0;
+    n = emit(ctx, sink, arg);
+    if (n < 0)
+        return -1;
+    *total += n;
+    return 0;
+} /* flush_chunk */
+
+/* ink to draw glyph p with, after the fill substitution */
+#define INK(ctx, p) ((p)->ink == '#' && (ctx)->fill ? (ctx)->fill : (p)->ink)
+
+/* the gap before a glyph and the width of a glyph, scaled */
+#define GAP_W(ctx) ((ctx)->gap * (ctx)->sx)
+#define GLYPH_W(ctx, p) \
+    (((ctx)->flags & SB_MONOSP ? (ctx)->max_w : (p)->w) * (ctx)->sx)
+
+/* the blanks before glyph p to center it, in monospace */
+#define PRE_W(ctx, p) ((ctx)->flags & SB_MONOSP \
+        ? (((ctx)->max_w - (p)->w) >> 1) * (ctx)->sx \
+        : 0)
+
+/* expands row i of glyph p (p->w columns) at d.  As with bm_expand(),
+ * BM_SLACK bytes past the end may be written. */
+static void
+expand_row(
+        const struct sb_ctx *ctx,
+        char *d,
+        const struct chrinfo *p,
+        int i)
+{
+    size_t k;
+
+    if (!ctx->text) {
+        bm_expand(d, bitmaps[p->off + i], p->w, INK(ctx, p), ' ');
+        return;
+    } /* if */
+    /* a text glyph, of a loaded font */
+    memcpy(d, ctx->text + p->off + (size_t) i * p->w, p->w);
+    if (ctx->fill)
+        for (k = 0; k < p->w; k++)
+            if (d[k] != ' ') d[k] = ctx->fill;
+} /* expand_row */
+
+/* the glyph atlas of the context: the rows of all the glyphs of the
+ * font, one glyph after the other, expanded (with the fill and the
+ * scale applied) and padded to the width of their cell (centered in
+ * it, in monospace), so each glyph row of the output is a single
+ * memcpy.  Glyph g has its h rows of GLYPH_W() bytes at atlas_off[g],
+ * they're drawn the first time it's used. */
+static int
+make_atlas(
+        struct sb_ctx *ctx)
+{
+    size_t g, n = ctx->nglyphs, *off;
+
+    if (!(off = malloc((n + 1) * sizeof *off)))
+        return -1;
+    off[0] = 0;
+    for (g = 0; g < n; g++)
+        off[g + 1] = off[g]
+            + ctx->glyphs[g].h * GLYPH_W(ctx, &ctx->glyphs[g]);
+    if (!(ctx->atlas = malloc(off[n] + 1))
+            || !(ctx->atlas_done = calloc(n, 1))) {
+        free(ctx->atlas);
+        ctx->atlas = NULL;
+        free(off);
+        return -1;
+    } /* if */
+    ctx->atlas_off = off;
+    return 0;
+} /* make_atlas */
+
+/* the rows of glyph p in the atlas, NULL if it can't be made */
+static const char *
+atlas_glyph(
+        struct sb_ctx *ctx,
+        const struct chrinfo *p)
+{
+    size_t g = p - ctx->glyphs, fw = GLYPH_W(ctx, p),
+           pre = PRE_W(ctx, p), x;
+    char row[UCHAR_MAX + BM_SLACK], *s, *d;
+    int i;
+
+    if (!ctx->atlas && make_atlas(ctx) < 0)
+        return NULL;
+    s = ctx->atlas + ctx->atlas_off[g];
+    if (ctx->atlas_done[g])
+        return s;
+    for (i = 0; i < p->h; i++) {
+        d = s + i * fw;
+        memset(d, ' ', fw);
+        expand_row(ctx, row, p, i);
+        if (ctx->sx == 1) {
+            memcpy(d + pre, row, p->w);
+            continue;
+        } /* if */
+        for (x = 0, d += pre; x < p->w; x++, d += ctx->sx)
+            memset(d, row[x], ctx->sx);
+    } /* for */
+    ctx->atlas_done[g] = 1;
+    return s;
+} /* atlas_glyph */
+
+/* width and height of the line whose glyphs are in ctx->cis */
+static size_t
+measure(
+        struct sb_ctx *ctx,
+        int *hp)
+{
+    size_t i, len = ctx->cis_len,
+           this_l = len ? (len - 1) * GAP_W(ctx) : 0;
+    int h = ctx->height;
+
+    for (i = 0; i < len; i++) {
+        const struct chrinfo *p = ctx->cis[i];
+        if (h < p->h) h = p->h;
+        this_l += GLYPH_W(ctx, p);
+    } /* for */
+    *hp = h;
+    return this_l;
+} /* measure */
+
+/* composes what goes between the last line and one this_l wide:
+ * the frame lines, or a blank line without frame */
+static void
+join(
+        struct sb_ctx *ctx,
+        size_t this_l)
+{
+    int flags = ctx->flags;
+    size_t last_l = ctx->last_l;
+
+    if (flags & SB_FRAME && (last_l || this_l)) {
+        const struct frame *f = ctx->frm;
+        if (last_l == 0) {
+            hor_line(ctx, this_l, f->top_l, f->top_r);
+        } else if (this_l == 0) {
+            hor_line(ctx, last_l, f->bot_l, f->bot_r);
+        } else if (last_l == this_l) {
+            hor_line(ctx, last_l, f->mid_l, f->mid_r);
+        } else { /* last_l != this_l, both != 0 */
+            size_t min = MIN(last_l, this_l);
+            size_t max = MAX(last_l, this_l);
+            hor_line(ctx, min + 1, f->mid_l,
+                last_l > this_l ? f->down : f->up);
+            hor_line(ctx, max - min - 1, "",
+                last_l > this_l ? f->down_end : f->up_end);
+        } /* else */
+    } else {
+        if (ctx->lineno++) ob_add(&ctx->out, "\n", 1);
+    } /* if */
+
+    /* an empty line has no frame, so its body starts uncolored */
+    if (!this_l)
+        set_color(ctx, SGR_NONE);
+    ctx->last_l = this_l;
+} /* join */
+
+/* the color in effect when the body of a line this_l wide starts,
+ * after join() */
+#define BODY_COLOR(ctx, this_l) \
+    ((ctx)->styled && (ctx)->flags & SB_FRAME && (this_l) \
+        && (ctx)->sgr[SGR_FRAME] ? SGR_FRAME : SGR_NONE)
+
+/* the glyph rows of the line in ctx->cis, without colors, row_l
+ * bytes each, h glyph rows high (each drawn ctx->sy times), frame
+ * included.  A version is made by DEF_ROWS() for each combination of
+ * SB_MONOSP, SB_FRAME and SB_UTF, with them as constants, so the
+ * inner loops have no tests on them, and each context takes the one
+ * of its flags once (see sb_new()).  Returns the bytes handed to the
+ * sink in chunked mode, or -1 on error (the rest is left in
+ * ctx->out).  The rows repeated are copied from the first one,
+ * except in chunked mode, where they're composed again, as the first
+ * may be already gone to the sink. */
+#define DEF_ROWS(name, MONOSP, LFT, RGT) \
+static ssize_t \
+name( \
+        struct sb_ctx *ctx, \
+        int h, \
+        size_t row_l, \
+        int chunked, \
+        sb_sink *sink, \
+        void *arg) \
+{ \
+    const size_t lft_l = sizeof LFT - 1, rgt_l = sizeof RGT - 1, \
+          len = ctx->cis_len, gap = GAP_W(ctx), \
+          cell = ctx->max_w * ctx->sx, \
+          glyph_l = lft_l + gap + cell + rgt_l; \
+    int sy = ctx->sy, i; \
+    ssize_t total = 0; \
+    char *d; \
+ \
+    if (ob_reserve(&ctx->out, chunked ? glyph_l : h * sy * row_l) < 0) \
+        return -1; \
+    d = ctx->out.b + ctx->out.len; \
+    for (i = 0; i < h * sy; i++) { \
+        size_t j; \
+        if (i % sy && !chunked) { \
+            memcpy(d, d - row_l, row_l); d += row_l; \
+            continue; \
+        } /* if */ \
+        if (chunked) { \
+            ctx->out.len = d - ctx->out.b; \
+            if (flush_chunk(ctx, sink, arg, &total, 1) < 0) \
+                return -1; \
+            d = ctx->out.b + ctx->out.len; \
+        } /* if */ \
+        memcpy(d, LFT, lft_l); d += lft_l; \
+        for (j = 0; j < len; j++) { \
+            const struct chrinfo *p = ctx->cis[j]; \
+            const char *a = atlas_glyph(ctx, p); \
+            size_t fld = MONOSP ? cell : (size_t) p->w * ctx->sx; \
+            int r = i / sy; \
+            if (chunked) { \
+                ctx->out.len = d - ctx->out.b; \
+                if (flush_chunk(ctx, sink, arg, &total, 0) < 0 \
+                        || ob_reserve(&ctx->out, glyph_l) < 0) \
+                    return -1; \
+                d = ctx->out.b + ctx->out.len; \
+            } /* if */ \
+            if (!a) { \
+                ctx->out.len = d - ctx->out.b; \
+                ctx->out.err = 1; \
+                return -1; \
+            } /* if */ \
+            if (j) { \
+                memset(d, ' ', gap); d += gap; \
+            } /* if */ \
+            if (r < p->h) \
+                memcpy(d, a + r * fld, fld); \
+            else \
+                memset(d, ' ', fld); \
+            d += fld; \
+        } /* for */ \
+        memcpy(d, RGT, rgt_l); d += rgt_l; \
+    } /* for */ \
+    ctx->out.len = d - ctx->out.b; \
+    return total; \
+} /* name */
+
+DEF_ROWS(rows_plain,        0, "",          "\n")
+DEF_ROWS(rows_m,            1, "",          "\n")
+DEF_ROWS(rows_f,            0, "| ",        " |\n")
+DEF_ROWS(rows_fm,           1, "| ",        " |\n")
+DEF_ROWS(rows_fu,           0, "\u2502 ",   " \u2502\n")
+DEF_ROWS(rows_fmu,          1, "\u2502 ",   " \u2502\n")
+
+/* by the flags SB_MONOSP, SB_FRAME and SB_UTF of the context */
+#define ROWS_FLAGS  (SB_MONOSP | SB_FRAME | SB_UTF)
+static rows_fn *const rows_fns[] = {
+    rows_plain, rows_m, rows_f, rows_fm,
+    rows_plain, rows_m, rows_fu, rows_fmu,
+};
+
+/* takes the renderers and the frame of the flags of the context */
+static void
+choose_rows(
+        struct sb_ctx *ctx)
+{
+    int flags = ctx->flags;
+
+    ctx->draw_rows = rows_fns[flags & ROWS_FLAGS];
+    ctx->draw_bare = rows_fns[flags & SB_MONOSP];
+    ctx->frm = flags & SB_UTF ? &frame_utf : &frame_ascii;
+} /* choose_rows */
+
+/* composes the glyph rows of the line in ctx->cis, this_l wide and h
+ * glyph rows high (each drawn ctx->sy times), and hands everything
+ * to the sink.  The rows repeated are copied from the first one,
+ * except in chunked mode, where they're composed again, as the first
+ * may be already gone to the sink. */
+static ssize_t
+body(
+        struct sb_ctx *ctx,
+        size_t this_l,
+        int h,
+        sb_sink *sink,
+        void *arg)
+{
+    size_t len = ctx->cis_len;
+
+    const char *frm_lft = "", *frm_rgt = "\n";
+    if (ctx->flags & SB_FRAME && len) {
+        frm_lft = ctx->frm->lft;
+        frm_rgt = ctx->frm->rgt;
+    } /* if */
+    size_t frm_lft_l = strlen(frm_lft),
+           frm_rgt_l = strlen(frm_rgt);
+
+    size_t row_l = frm_lft_l + this_l + frm_rgt_l;
+    int sy = ctx->sy, chunked = (size_t) h * sy * row_l > SB_CHUNK;
+    ssize_t total = 0, res;
+
+    ctx->rows = h * sy;
+
+    if (ctx->styled) {
+        total = styled_rows(ctx, h, this_l, frm_lft, frm_rgt,
+                chunked, sink, arg);
+        set_color(ctx, SGR_NONE);
+        res = emit(ctx, sink, arg);
+        return res < 0 || total < 0 ? -1 : total + res;
+    } /* if */
+
+    if (ctx->flags & SB_WRITEV && !(ctx->flags & SB_ROWS)
+            && sink == sb_sink_fd)
+        return rows_iov(ctx, h, row_l, *(int *) arg);
+
+    total = (len ? ctx->draw_rows : ctx->draw_bare)(ctx, h, row_l,
+            chunked, sink, arg);
+    res = emit(ctx, sink, arg);
+    return res < 0 || total < 0 ? -1 : total + res;
+} /* body */
+
+/* blanks for the long gaps and empty glyph rows of rows_iov() */
+#define SPACES16    "                "
+#define SPACES128   SPACES16 SPACES16 SPACES16 SPACES16 \
+                    SPACES16 SPACES16 SPACES16 SPACES16
+static const char spaces[] =
+    SPACES128 SPACES128 SPACES128 SPACES128;
+
+/* writes the iovecs gathered in the context to fd, adding the bytes
+ * written to *total.  The output buffer, where the short pieces are
+ * composed, is empty again after this. */
+static int
+iov_flush(
+        struct sb_ctx *ctx,
+        int fd,
+        ssize_t *total)
+{
+    struct iovec *v = ctx->iov;
+    int n = ctx->niov, k;
+    unsigned long long t0 = ST_START(ctx);
+    unsigned long calls = 0;
+    size_t bytes = 0;
+
+    ctx->niov = ctx->iov_cut = 0;
+    ctx->iov_gen++;
+    ctx->out.len = 0;
+    for (k = 0; k < n; k++)
+        bytes += v[k].iov_len;
+    while (n > 0) {
+        ssize_t res = writev(fd, v, n);
+        atomic_fetch_add_explicit(&n_writes, 1, memory_order_relaxed);
+        calls++;
+        if (res < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        } /* if */
+        /* skip what was written, maybe part of an iovec */
+        while (n > 0 && (size_t) res >= v->iov_len) {
+            res -= v->iov_len;
+            v++; n--;
+        } /* while */
+        if (n > 0) {
+            v->iov_base = (char *) v->iov_base + res;
+            v->iov_len -= res;
+        } /* if */
+    } /* while */
+    if (ctx->stats) {
+        ctx->st_bytes += bytes;
+        ctx->st.sinks += calls;
+        ctx->st.t_output += now_ns() - t0;
+    } /* if */
+    *total += bytes;
+    return 0;
+} /* iov_flush */
+
+/* points an iovec at the n bytes at b, or extends the last one if
+ * they follow it (and it's past the cut).  The last slot is kept for
+ * iov_close(), so when it's reached, what's gathered is written
+ * first. */
+static int
+iov_add(
+        struct sb_ctx *ctx,
+        int fd,
+        const char *b,
+        size_t n,
+        ssize_t *total)
+{
+    struct iovec *last = ctx->iov + ctx->niov;
+
+    if (!n)
+        return 0;
+    if (ctx->niov > ctx->iov_cut
+            && (char *) last[-1].iov_base + last[-1].iov_len == b) {
+        last[-1].iov_len += n;
+        return 0;
+    } /* if */
+    if (ctx->niov >= IOV_MAX - 1) {
+        if (iov_flush(ctx, fd, total) < 0)
+            return -1;
+        last = ctx->iov;
+    } /* if */
+    last->iov_base = (char *) b;
+    last->iov_len = n;
+    ctx->niov++;
+    return 0;
+} /* iov_add */
+
+/* ends the run of bytes composed in the output buffer from s to d,
+ * pointing an iovec at it.  Nothing is written, as the buffer can't
+ * be emptied before that, there's always a slot left for this. */
+static void
+iov_close(
+        struct sb_ctx *ctx,
+        const char *s,
+        const char *d)
+{
+    struct iovec *last = ctx->iov + ctx->niov;
+
+    ctx->out.len = d - ctx->out.b;
+    if (d == s)
+        return;
+    if (ctx->niov > ctx->iov_cut
+            && (char *) last[-1].iov_base + last[-1].iov_len == s) {
+        last[-1].iov_len += d - s;
+        return;
+    } /* if */
+    last->iov_base = (char *) s;
+    last->iov_len = d - s;
+    ctx->niov++;
+} /* iov_close */
+
+/* a piece too long to be copied, n bytes at b (or n blanks, if b is
+ * NULL), in the middle of the run *s to *d, which is ended before it
+ * and started again after it */
+static int
+iov_long(
+        struct sb_ctx *ctx,
+        int fd,
+        char **s,
+        char **d,
+        const char *b,
+        size_t n,
+        ssize_t *total)
+{
+    iov_close(ctx, *s, *d);
+    if (b) {
+        if (iov_add(ctx, fd, b, n, total) < 0)
+            return -1;
+    } else {
+        for (; n > sizeof spaces - 1; n -= sizeof spaces - 1)
+            if (iov_add(ctx, fd, spaces, sizeof spaces - 1, total) < 0)
+                return -1;
+        if (iov_add(ctx, fd, spaces, n, total) < 0)
+            return -1;
+    } /* if */
+    *s = *d = ctx->out.b + ctx->out.len;
+    return 0;
+} /* iov_long */
+
+/* body() for SB_WRITEV contexts writing to a file descriptor: the
+ * rows are composed in the output buffer, as usual, and handed to
+ * writev(2) with what join() left there before them, but the long
+ * pieces (glyph rows and blanks of big scales) are written straight
+ * from the atlas and a static block of blanks, and the rows repeated
+ * by the scale point again at the first one, so none of them is
+ * copied.  Returns the bytes written, or -1 on error. */
+static ssize_t
+rows_iov(
+        struct sb_ctx *ctx,
+        int h,
+        size_t row_l,
+        int fd)
+{
+    struct outbuf *o = &ctx->out;
+    size_t j, len = ctx->cis_len, gap = GAP_W(ctx),
+           lft_l = 0, rgt_l = 1;
+    const char *lft = "", *rgt = "\n";
+    int i, sy = ctx->sy, k0 = 0, k1 = 0;
+    unsigned long gen = 0;
+    ssize_t total = 0;
+    char *s, *d;
+
+    if (o->err)
+        return emit(ctx, sb_sink_fd, &fd); /* reports ENOMEM */
+    if (!ctx->iov && !(ctx->iov = malloc(IOV_MAX * sizeof *ctx->iov)))
+        goto fail;
+    if (ob_reserve(o, MAX(row_l, SB_CHUNK)) < 0)
+        goto fail;
+    if (ctx->flags & SB_FRAME && len) {
+        lft = ctx->frm->lft; lft_l = strlen(lft);
+        rgt = ctx->frm->rgt; rgt_l = strlen(rgt);
+    } /* if */
+
+    /* what join() left */
+    ctx->niov = ctx->iov_cut = 0;
+    iov_close(ctx, o->b, o->b + o->len);
+    for (i = 0; i < h * sy; i++) {
+        int r = i / sy;
+
+        /* the same row again, if its iovecs are still there */
+        if (i % sy && gen == ctx->iov_gen
+                && ctx->niov + (k1 - k0) < IOV_MAX) {
+            memcpy(ctx->iov + ctx->niov, ctx->iov + k0,
+                    (k1 - k0) * sizeof *ctx->iov);
+            ctx->niov += k1 - k0;
+            ctx->iov_cut = ctx->niov;
+            continue;
+        } /* if */
+
+        if ((o->len + row_l > o->cap || ctx->niov >= IOV_MAX - 1)
+                && iov_flush(ctx, fd, &total) < 0)
+            goto fail;
+        if (sy > 1)
+            ctx->iov_cut = ctx->niov; /* not joined to the last row */
+        k0 = ctx->niov;
+        gen = ctx->iov_gen;
+
+        s = d = o->b + o->len;
+        memcpy(d, lft, lft_l); d += lft_l;
+        for (j = 0; j < len; j++) {
+            const struct chrinfo *p = ctx->cis[j];
+            const char *a = atlas_glyph(ctx, p);
+            size_t fld = GLYPH_W(ctx, p);
+            if (!a)
+                goto fail;
+            if (j && gap < IOV_REF) {
+                memset(d, ' ', gap); d += gap;
+            } else if (j && iov_long(ctx, fd, &s, &d, NULL, gap,
+                    &total) < 0) {
+                goto fail;
+            } /* if */
+            if (fld >= IOV_REF) {
+                if (iov_long(ctx, fd, &s, &d,
+                        r < p->h ? a + r * fld : NULL, fld, &total) < 0)
+                    goto fail;
+            } else if (r < p->h) {
+                memcpy(d, a + r * fld, fld); d += fld;
+            } else {
+                memset(d, ' ', fld); d += fld;
+            } /* if */
+        } /* for */
+        memcpy(d, rgt, rgt_l); d += rgt_l;
+        iov_close(ctx, s, d);
+        k1 = ctx->niov;
+    } /* for */
+    if (iov_flush(ctx, fd, &total) < 0)
+        goto fail;
+    return total;
+
+fail:
+    ctx->niov = ctx->iov_cut = 0;
+    o->len = 0;
+    return -1;
+} /* rows_iov */
+
+/* width of a glyph, the gap before it included */
+#define CELL_W(ctx, p) (GAP_W(ctx) + GLYPH_W(ctx, p))
+
+/* finds where the banner line starting at glyph a ends, to fit in
+ * ctx->cols columns: the line is [a, *b) and the next one starts at
+ * *next.  Lines are broken at a space if there's one (the space is
+ * dropped), or else between glyphs, and have at least a glyph.  The
+ * prefix sums of the glyph widths (psum[k] is the width of the first
+ * k glyphs, with their gaps) are computed once per text, so the line
+ * can be laid out again for another width cheaply. */
+static void
+layout(
+        struct sb_ctx *ctx,
+        size_t a,
+        size_t *b,
+        size_t *next)
+{
+    const struct chrinfo *space = GLYPH(ctx, L' ');
+    size_t len = ctx->cis_len, lo, hi, avail, j;
+
+    if (!ctx->cols || a >= len) {
+        *b = *next = len;
+        return;
+    } /* if */
+    if (ctx->psum_len != len + 1) {
+        if (ctx->psum_cap < len + 1) {
+            size_t *p = realloc(ctx->psum, (len + 1) * sizeof *p);
+            if (!p) { /* no wrapping, then */
+                *b = *next = len;
+                return;
+            } /* if */
+            ctx->psum = p;
+            ctx->psum_cap = len + 1;
+        } /* if */
+        ctx->psum[0] = 0;
+        for (j = 0; j < len; j++)
+            ctx->psum[j + 1] = ctx->psum[j] + CELL_W(ctx, ctx->cis[j]);
+        ctx->psum_len = len + 1;
+    } /* if */
+
+    /* the frame takes four columns, the first glyph has no gap */
+    avail = ctx->cols + GAP_W(ctx);
+    if (ctx->flags & SB_FRAME)
+        avail = avail > 4 ? avail - 4 : 0;
+
+    /* the last glyph lo such that [a, lo) fits */
+    lo = a + 1; hi = len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo + 1) / 2;
+        if (ctx->psum[mid] - ctx->psum[a] <= avail)
+            lo = mid;
+        else
+            hi = mid - 1;
+    } /* while */
+    if (lo == len) {
+        *b = *next = len;
+        return;
+    } /* if */
+    for (j = lo; j > a; j--) {
+        if (ctx->cis[j] == space) {
+            *b = j;
+            *next = j + 1;
+            return;
+        } /* if */
+    } /* for */
+    *b = *next = lo;
+} /* layout */
+
+/* composes the banner lines of the text whose glyphs are in ctx->cis,
+ * wrapped as needed.  The join before the first one is only done if
+ * join_first (otherwise the state between lines is left as it was),
+ * and the widths of the first and last banner lines are stored in
+ * *first and *last.  With more (a line given in parts, see
+ * sb_render_part()), only the banner lines already laid out for good
+ * are composed, the glyphs of the next one are left in ctx->cis for
+ * the next part to add to. */
+static ssize_t
+compose_lines(
+        struct sb_ctx *ctx,
+        int join_first,
+        int more,
+        size_t *first,
+        size_t *last,
+        sb_sink *sink,
+        void *arg)
+{
+    const struct chrinfo **all = ctx->cis;
+    size_t all_len = ctx->cis_len, a = 0, b, next;
+    size_t last_l = ctx->last_l;
+    long lineno = ctx->lineno, done = ctx->part_lines;
+    ssize_t total = 0, res = 0;
+
+    /* the banner lines of the parts before */
+    if (done)
+        *last = ctx->last_l;
+    do {
+        int h;
+        size_t this_l;
+        unsigned long long t0 = ST_START(ctx), out0;
+
+        layout(ctx, a, &b, &next);
+        /* the end of the banner line may depend on what's to come,
+         * or there's nothing left after the parts before */
+        if ((more && b == all_len) || (ctx->part_lines && a == all_len))
+            break;
+        ctx->cis = all + a;
+        ctx->cis_len = b - a;
+        this_l = measure(ctx, &h);
+        ST_ADD(ctx, t_measure, t0);
+
+        /* the composition, without the time spent in the sink */
+        t0 = ST_START(ctx);
+        out0 = ctx->st.t_output;
+        if (!ctx->part_lines) {
+            *first = this_l;
+            if (join_first)
+                join(ctx, this_l);
+            else
+                ctx->cur = BODY_COLOR(ctx, this_l);
+        } else {
+            /* a separator is due, whatever came before the text */
+            long n = ctx->lineno;
+            ctx->last_l = *last;
+            ctx->lineno = 1;
+            join(ctx, this_l);
+            ctx->lineno += n - 1;
+        } /* if */
+        *last = this_l;
+        ctx->part_lines++;
+        ctx->seg = a;
+        res = body(ctx, this_l, h, sink, arg);
+        ST_ADD(ctx, t_compose, t0 + (ctx->st.t_output - out0));
+        ctx->cis = all;
+        ctx->cis_len = all_len;
+        if (res < 0) {
+            ctx->part = ctx->part_lines = 0;
+            return -1;
+        } /* if */
+        total += res;
+        a = next;
+    } while (a < all_len);
+    if (more) {
+        memmove(all, all + a, (all_len - a) * sizeof *all);
+        ctx->cis_len = all_len - a;
+        ctx->psum_len = 0;
+    } else {
+        ctx->part_lines = 0;
+    } /* if */
+    if (!join_first) {
+        ctx->last_l = last_l;
+        ctx->lineno = lineno;
+    } else if (ctx->part_lines != done || !more) {
+        ctx->last_l = *last;
+    } /* if */
+    return total;
+} /* compose_lines */
+
+/* composes the text whose glyphs are in ctx->cis */
+static ssize_t
+compose(
+        struct sb_ctx *ctx,
+        sb_sink *sink,
+        void *arg)
+{
+    size_t first, last;
+
+    return compose_lines(ctx, 1, 0, &first, &last, sink, arg);
+} /* compose */
+
+ssize_t
+sb_relayout(
+        struct sb_ctx *ctx,
+        sb_sink *sink,
+        void *arg)
+{
+    return compose(ctx, sink, arg);
+} /* sb_relayout */
+
+/* the glyph rows, with colors.  Blanks don't change the color in
+ * effect (only the foreground is set), so consecutive ink of the
+ * same color takes a single escape sequence, even across glyphs.
+ * Returns the bytes already handed to the sink (in chunked mode) or
+ * -1 on error. */
+static ssize_t
+styled_rows(
+        struct sb_ctx *ctx,
+        int h,
+        size_t this_l,
+        const char *frm_lft,
+        const char *frm_rgt,
+        int chunked,
+        sb_sink *sink,
+        void *arg)
+{
+    int flags = ctx->flags;
+    size_t len = ctx->cis_len,
+           n_pal = ctx->n_sgr - SGR_PALETTE;
+    int frame = flags & SB_FRAME && len,
+        frm_c = ctx->sgr[SGR_FRAME] ? SGR_FRAME : SGR_NONE;
+    ssize_t total = 0;
+    int i;
+
+    for (i = 0; i < h * ctx->sy; i++) {
+        size_t j, x = 0;
+        if (chunked && flush_chunk(ctx, sink, arg, &total, 1) < 0)
+            return -1;
+        if (frame) {
+            set_color(ctx, frm_c);
+            ob_add(&ctx->out, frm_lft, strlen(frm_lft));
+        } /* if */
+        for (j = 0; j < len; j++) {
+            const struct chrinfo *p = ctx->cis[j];
+            const char *a = atlas_glyph(ctx, p), *tmp;
+            size_t pre = j ? GAP_W(ctx) : 0,
+                   fld = GLYPH_W(ctx, p);
+            size_t k, span = 0, r = i / ctx->sy;
+            if (!a) {
+                errno = ENOMEM;
+                return -1;
+            } /* if */
+            if (chunked && flush_chunk(ctx, sink, arg, &total, 0) < 0)
+                return -1;
+            ob_fill(&ctx->out, ' ', pre);
+            x += pre;
+            if (r >= p->h) {
+                ob_fill(&ctx->out, ' ', fld);
+                x += fld;
+                continue;
+            } /* if */
+            tmp = a + r * fld;
+            for (k = 0; k < fld; k++) {
+                int c;
+                if (tmp[k] == ' ') continue;
+                switch (ctx->color) {
+                case SB_COLOR_RUN:
+                    c = ctx->sgr[SGR_INK] ? SGR_INK : SGR_NONE;
+                    break;
+                case SB_COLOR_GLYPH:
+                    c = SGR_PALETTE + j % n_pal;
+                    break;
+                case SB_COLOR_GRADIENT:
+                    c = SGR_PALETTE + (x + k) * n_pal / this_l;
+                    break;
+                default:
+                    c = SGR_NONE;
+                    break;
+                } /* switch */
+                if (c != ctx->cur) {
+                    ob_add(&ctx->out, tmp + span, k - span);
+                    span = k;
+                    set_color(ctx, c);
+                } /* if */
+            } /* for */
+            ob_add(&ctx->out, tmp + span, fld - span);
+            x += fld;
+        } /* for */
+        if (frame) set_color(ctx, frm_c);
+        ob_add(&ctx->out, frm_rgt, strlen(frm_rgt));
+    } /* for */
+    return total;
+} /* styled_rows */
+
+static void
+set_color(
+        struct sb_ctx *ctx,
+        int c)
+{
+    const char *s, *was;
+
+    if (c == ctx->cur)
+        return;
+    s = c == SGR_NONE || !ctx->sgr[c]
+        ? "\033[m"
+        : ctx->sgr[c];
+    was = ctx->cur == SGR_NONE || !ctx->sgr[ctx->cur]
+        ? "\033[m"
+        : ctx->sgr[ctx->cur];
+    ctx->cur = c;
+    if (strcmp(s, was))
+        ob_add(&ctx->out, s, strlen(s));
+} /* set_color */
+
+/* builds the escape sequence for the SGR parameters s, resetting
+ * the attributes first so each color stands on its own */
+static char *
+mk_sgr(
+        const char *s)
+{
+    char *res;
+
+    if (!s || !*s)
+        return NULL;
+    res = malloc(strlen(s) + 6);
+    if (res)
+        sprintf(res, "\033[0;%sm", s);
+    return res;
+} /* mk_sgr */
+
+int
+sb_set_style(
+        struct sb_ctx *ctx,
+        const struct sb_style *st)
+{
+    size_t i, n = SGR_PALETTE + (st->palette ? st->npalette : 0);
+    char **sgr;
+
+    if ((st->color == SB_COLOR_GLYPH || st->color == SB_COLOR_GRADIENT)
+            && n == SGR_PALETTE) {
+        errno = EINVAL;
+        return -1;
+    } /* if */
+    sgr = calloc(n, sizeof *sgr);
+    if (!sgr) return -1;
+    for (i = 0; i < n; i++) {
+        const char *s = i == SGR_FRAME
+            ? st->frame
+            : i == SGR_INK
+                ? st->ink
+                : st->palette[i - SGR_PALETTE];
+        if (s && *s && !(sgr[i] = mk_sgr(s))) {
+            while (i--) free(sgr[i]);
+            free(sgr);
+            return -1;
+        } /* if */
+    } /* for */
+
+    while (ctx->n_sgr--)
+        free(ctx->sgr[ctx->n_sgr]);
+    free(ctx->sgr);
+    ctx->sgr = sgr;
+    ctx->n_sgr = n;
+    if (ctx->fill != st->fill)
+        drop_atlas(ctx);
+    ctx->fill = st->fill;
+    ctx->color = st->color;
+    ctx->styled = st->color != SB_COLOR_NONE || sgr[SGR_FRAME];
+    ctx->cur = SGR_NONE;
+    return 0;
+} /* sb_set_style */
+
+ssize_t
+sb_render(
+        struct sb_ctx *ctx,
+        const wchar_t *s,
+        size_t len,
+        sb_sink *sink,
+        void *arg)
+{
+    size_t i;
+    unsigned long long t0 = ST_START(ctx);
+
+    /* resolve the glyphs only once per line */
+    if (cis_reserve(ctx, len) < 0)
+        return -1;
+    for (i = 0; i < len; i++)
+        ctx->cis[i] = GLYPH(ctx, s[i]);
+    ctx->cis_len = len;
+    ctx->psum_len = 0;
+    if (ctx->stats) {
+        ST_ADD(ctx, t_decode, t0);
+        ctx->st.lines++;
+        count_glyphs(ctx, 0);
+    } /* if */
+
+    return compose(ctx, sink, arg);
+} /* sb_render */
+
+/* resolves the glyphs of the text s into ctx->cis, after those
+ * already there.  ASCII and Latin-1 bytes index the glyphs of the
+ * first page directly.  With more (text of the same line to come in
+ * the next call), a character cut at the end is kept to be completed
+ * by the next part: its bytes in ctx->carry (UTF-8) or in the
+ * conversion state (locale). */
+static int
+decode(
+        struct sb_ctx *ctx,
+        const char *s,
+        size_t len,
+        int more)
+{
+    const struct chrinfo *const *hot = ctx->hot;
+    const struct chrinfo **cis;
+    size_t i, n = ctx->cis_len;
+
+    /* no more glyphs than bytes */
+    if (cis_reserve(ctx, n + ctx->carry_len + len) < 0)
+        return -1;
+    cis = ctx->cis;
+    ctx->psum_len = 0;
+
+    switch (ctx->enc) {
+    case SB_ENC_LATIN1:
+        for (i = 0; i < len; i++)
+            cis[n + i] = hot[(unsigned char) s[i]];
+        ctx->cis_len = n + len;
+        return 0;
+
+    case SB_ENC_UTF8:
+        if (ctx->carry_len) {
+            /* completed with the first bytes of this part */
+            char tmp[2 * sizeof ctx->carry];
+            size_t t = ctx->carry_len, k = MIN(len, sizeof ctx->carry);
+
+            memcpy(tmp, ctx->carry, t);
+            memcpy(tmp + t, s, k);
+            if (more && utf8_tail(tmp, t + k) == t + k) {
+                memcpy(ctx->carry, tmp, ctx->carry_len = t + k);
+                return 0;
+            } /* if */
+            for (i = 0; i < t; ) {
+                wchar_t c;
+                i += utf8_decode(tmp + i, t + k - i, &c);
+                cis[n++] = GLYPH(ctx, c);
+            } /* for */
+            s += i - t; len -= i - t;
+            ctx->carry_len = 0;
+        } /* if */
+        if (more) {
+            size_t t = utf8_tail(s, len);
+            memcpy(ctx->carry, s + len - t, t);
+            ctx->carry_len = t;
+            len -= t;
+        } /* if */
+        while (len > 0) {
+            size_t a = utf8_ascii(s, len);
+            wchar_t c;
+            for (i = 0; i < a; i++)
+                cis[n++] = hot[(unsigned char) s[i]];
+            s += a; len -= a;
+            if (!len) break;
+            i = utf8_decode(s, len, &c);
+            cis[n++] = GLYPH(ctx, c);
+            s += i; len -= i;
+        } /* while */
+        ctx->cis_len = n;
+        return 0;
+    } /* switch */
+
+    /* SB_ENC_LOCALE */
+    while (len > 0) {
+        wchar_t c;
+        size_t res = mbrtowc(&c, s, len, &ctx->mbst);
+        switch (res) {
+        case (size_t) -2: /* incomplete, at the end */
+            if (more) { /* the state keeps what was read */
+                len = 0;
+                continue;
+            } /* if */
+            res = len;
+            /* FALLTHROUGH */
+        case (size_t) -1: /* invalid sequence, skip a byte */
+            if (res == (size_t) -1) res = 1;
+            memset(&ctx->mbst, 0, sizeof ctx->mbst);
+            c = 0xfffe;
+            break;
+        case 0: /* a null character */
+            res = 1;
+            break;
+        } /* switch */
+        cis[n++] = GLYPH(ctx, c);
+        s += res; len -= res;
+    } /* while */
+    ctx->cis_len = n;
+    return 0;
+} /* decode */
+
+/* decode(), taking the statistics.  A line starts unless the last
+ * call was for a part of it with more to come. */
+static int
+decode_line(
+        struct sb_ctx *ctx,
+        const char *s,
+        size_t len,
+        int more)
+{
+    unsigned long long t0 = ST_START(ctx);
+    size_t from;
+
+    if (!ctx->part) {
+        ctx->cis_len = ctx->carry_len = 0;
+        memset(&ctx->mbst, 0, sizeof ctx->mbst);
+        if (ctx->stats)
+            ctx->st.lines++;
+    } /* if */
+    from = ctx->cis_len;
+    ctx->part = more;
+    if (decode(ctx, s, len, more) < 0)
+        return -1;
+    if (ctx->stats) {
+        ST_ADD(ctx, t_decode, t0);
+        count_glyphs(ctx, from);
+    } /* if */
+    return 0;
+} /* decode_line */
+
+ssize_t
+sb_render_utf8(
+        struct sb_ctx *ctx,
+        const char *s,
+        size_t len,
+        sb_sink *sink,
+        void *arg)
+{
+    if (decode_line(ctx, s, len, 0) < 0)
+        return -1;
+    return compose(ctx, sink, arg);
+} /* sb_render_utf8 */
+
+ssize_t
+sb_render_part(
+        struct sb_ctx *ctx,
+        const char *s,
+        size_t len,
+        int more,
+        sb_sink *sink,
+        void *arg)
+{
+    size_t first, last;
+
+    if (decode_line(ctx, s, len, more) < 0)
+        return -1;
+    return compose_lines(ctx, 1, more, &first, &last, sink, arg);
+} /* sb_render_part */
+
+ssize_t
+sb_body(
+        struct sb_ctx *ctx,
+        const char *s,
+        size_t len,
+        size_t width[2],
+        sb_sink *sink,
+        void *arg)
+{
+    if (decode_line(ctx, s, len, 0) < 0)
+        return -1;
+    return compose_lines(ctx, 0, 0, &width[0], &width[1], sink, arg);
+} /* sb_body */
+
+ssize_t
+sb_join(
+        struct sb_ctx *ctx,
+        const size_t width[2],
+        sb_sink *sink,
+        void *arg)
+{
+    unsigned long long t0 = ST_START(ctx);
+
+    join(ctx, width[0]);
+    ctx->last_l = width[1];
+    /* the body leaves no color in effect */
+    ctx->cur = SGR_NONE;
+    ST_ADD(ctx, t_compose, t0);
+    return emit(ctx, sink, arg);
+} /* sb_join */
+
+ssize_t
+sb_join_body(
+        struct sb_ctx *ctx,
+        const size_t width[2],
+        const char *body,
+        size_t len,
+        sb_sink *sink,
+        void *arg)
+{
+    unsigned long long t0 = ST_START(ctx);
+    ssize_t total = 0;
+
+    join(ctx, width[0]);
+    ctx->last_l = width[1];
+    ctx->cur = SGR_NONE;
+    ST_ADD(ctx, t_compose, t0);
+
+    /* one writev(2), pointing at the join and at the body */
+    if (ctx->flags & SB_WRITEV && !(ctx->flags & SB_ROWS)
+            && sink == sb_sink_fd && !ctx->out.err
+            && (ctx->iov
+                || (ctx->iov = malloc(IOV_MAX * sizeof *ctx->iov)))) {
+        int fd = *(int *) arg;
+        ctx->niov = ctx->iov_cut = 0;
+        iov_close(ctx, ctx->out.b, ctx->out.b + ctx->out.len);
+        if (iov_add(ctx, fd, body, len, &total) < 0
+                || iov_flush(ctx, fd, &total) < 0)
+            return -1;
+    } else {
+        /* otherwise copied once, after the join, for a single write */
+        ob_add(&ctx->out, body, len);
+        if ((total = emit(ctx, sink, arg)) < 0)
+            return -1;
+    } /* if */
+    /* the body was counted by the sb_body() that rendered it */
+    if (ctx->stats)
+        ctx->st_bytes -= len;
+    return total;
+} /* sb_join_body */
+
+ssize_t
+sb_close(
+        struct sb_ctx *ctx,
+        sb_sink *sink,
+        void *arg)
+{
+    if (ctx->flags & SB_FRAME && ctx->last_l) {
+        hor_line(ctx, ctx->last_l, ctx->frm->bot_l, ctx->frm->bot_r);
+    } /* if */
+    set_color(ctx, SGR_NONE);
+    ctx->last_l = 0;
+    return emit(ctx, sink, arg);
+} /* sb_close */
+
+int
+sb_geometry(
+        struct sb_ctx *ctx,
+        struct sb_geom *g)
+{
+    const struct chrinfo **cis = ctx->cis + ctx->seg;
+    size_t j, x, len = ctx->cis_len - ctx->seg;
+
+    if (ctx->col_cap < len + 1) {
+        size_t *p = realloc(ctx->col, (len + 1) * sizeof *p);
+        if (!p) return -1;
+        ctx->col = p;
+        ctx->col_cap = len + 1;
+    } /* if */
+
+    x = ctx->flags & SB_FRAME && len ? 2 : 0;
+    for (j = 0; j < len; j++) {
+        ctx->col[j] = x;
+        x += (j ? GAP_W(ctx) : 0) + GLYPH_W(ctx, cis[j]);
+    } /* for */
+    ctx->col[len] = x;
+
+    g->rows = ctx->rows;
+    g->ncells = len;
+    g->col = ctx->col;
+    return 0;
+} /* sb_geometry */
+
+void
+sb_reset(
+        struct sb_ctx *ctx)
+{
+    ctx->lineno = 0;
+    ctx->last_l = 0;
+    ctx->part = ctx->part_lines = 0;
+    ctx->out.len = 0;
+    ctx->out.err = 0;
+    ctx->cur = SGR_NONE;
+} /* sb_reset */
+
+void
+sb_resume(
+        struct sb_ctx *ctx)
+{
+    sb_reset(ctx);
+    ctx->lineno = 1;
+} /* sb_resume */
+
+static void
+hor_line(
+        struct sb_ctx *ctx,
+        size_t len,
+        const char *lft,
+        const char *rgt)
+{
+    const char *the_line = ctx->frm->line;
+    size_t the_line_size = ctx->frm->line_l;
+    size_t start = ctx->out.len;
+
+    len *= ctx->frm->cw;
+    if (ctx->styled && ctx->sgr[SGR_FRAME])
+        set_color(ctx, SGR_FRAME);
+    ob_add(&ctx->out, lft, strlen(lft));
+    while (len > the_line_size) {
+        ob_add(&ctx->out, the_line, the_line_size);
+        len -= the_line_size;
+    } /* while */
+    /* len <= the_line_size */
+    ob_add(&ctx->out, the_line, len);
+    ob_add(&ctx->out, rgt, strlen(rgt));
+    if (ctx->stats)
+        ctx->st.frame_bytes += ctx->out.len - start;
+} /* hor_line */
+
+/* makes room for n more bytes in the buffer */
+static int
+ob_reserve(
+        struct outbuf *o,
+        size_t n)
+{
+    size_t cap;
+    char *b;
+
+    if (o->err)
+        return -1;
+    if (o->len + n <= o->cap)
+        return 0;
+
+    for (cap = o->cap ? o->cap : BUFSIZ; cap < o->len + n; cap <<= 1)
+        continue;
+    b = realloc(o->b, cap);
+    if (!b) {
+        o->err = 1;
+        return -1;
+    } /* if */
+    o->b = b;
+    o->cap = cap;
+    return 0;
+} /* ob_reserve */
+
+static void
+ob_add(
+        struct outbuf *o,
+        const char *s,
+        size_t n)
+{
+    if (ob_reserve(o, n) < 0)
+        return;
+    memcpy(o->b + o->len, s, n);
+    o->len += n;
+} /* ob_add */
+
+static void
+ob_fill(
+        struct outbuf *o,
+        int c,
+        size_t n)
+{
+    if (ob_reserve(o, n) < 0)
+        return;
+    memset(o->b + o->len, c, n);
+    o->len += n;
+} /* ob_fill */
+
+int
+sb_sink_fd(
+        void *arg,
+        const char *buf,
+        size_t len)
+{
+    int fd = *(int *) arg;
+
+    while (len > 0) {
+        ssize_t res = write(fd, buf, len);
+        atomic_fetch_add_explicit(&n_writes, 1, memory_order_relaxed);
+        if (res < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        } /* if */
+        buf += res; len -= res;
+    } /* while */
+    return 0;
+} /* sb_sink_fd */
+
+int
+sb_sink_mem(
+        void *arg,
+        const char *buf,
+        size_t len)
+{
+    struct sb_mem *m = arg;
+
+    if (m->len < m->size)
+        memcpy(m->buf + m->len, buf, MIN(len, m->size - m->len));
+    m->len += len;
+    return 0;
+} /* sb_sink_mem */
@@ -0,0 +1,232 @@
+/* mkfont.c --- generate the constant font tables for sysvbanner.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 04:30:12 EEST 2026
+ *
+ * This program is run at build time.  It measures every glyph in
+ * glyphs.h (width, height and the maximum width of the font), packs
+ * its rows into bitmaps and builds the unicode lookup index, then
+ * prints, on stdout, a C source (font.c) with all of it as const
+ * tables, so sysvbanner doesn't have to do any of this on each
+ * start.  The tables refer to each other with offsets and glyph
+ * numbers, never with pointers, so they need no relocations.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+#include "font.h"
+
+#define F(fmt) __FILE__":%d:%s: " fmt, __LINE__, __func__
+
+/* mutable versions of the font structures, used only to read the
+ * glyph definitions */
+#define chrinfo     src_chrinfo
+#define range       src_range
+#define ci_invalid  src_ci_invalid
+#define ranges      src_ranges
+
+struct chrinfo {
+    size_t w, h;
+    char **s;
+    int ink;            /* ink character, computed here */
+    size_t off;         /* offset of the rows in bitmaps[] */
+    size_t num;         /* number of the glyph in glyphs[] */
+};
+
+struct range {
+    wchar_t fst;
+    wchar_t lst;
+    struct chrinfo *ci;
+};
+
+#include "glyphs.h"
+
+/* index pages, each entry holds the number of the glyph (0 being
+ * ci_invalid's) */
+struct page {
+    unsigned short num[IDX_PGSZ];
+};
+
+static struct page  *pages;
+static int           n_pages;
+static int           dir[IDX_NPAGES];
+
+/* packs a glyph row, checking that it can be represented */
+static bm_row
+pack_row(
+        struct chrinfo *ci,
+        wchar_t c,
+        const char *s)
+{
+    bm_row bits = 0;
+    int i;
+
+    for (i = 0; s[i]; i++) {
+        if (s[i] == ' ')
+            continue;
+        if (ci->ink != s[i]) {
+            fprintf(stderr,
+                    F("glyph 0x%04x: more than one ink character "
+                      "('%c' and '%c')\n"),
+                    (unsigned) c, ci->ink, s[i]);
+            exit(EXIT_FAILURE);
+        } /* if */
+        bits |= (bm_row) 1 << i;
+    } /* for */
+    return bits;
+} /* pack_row */
+
+static int
+new_page(void)
+{
+    int i;
+
+    pages = realloc(pages, (n_pages + 1) * sizeof *pages);
+    if (!pages) {
+        fprintf(stderr, F("realloc: out of memory\n"));
+        exit(EXIT_FAILURE);
+    } /* if */
+    for (i = 0; i < IDX_PGSZ; i++)
+        pages[n_pages].num[i] = 0;
+    return n_pages++;
+} /* new_page */
+
+int
+main(void)
+{
+    struct range *r;
+    int max_width = 0;
+    size_t n_rows = 0, n_glyphs = 0;
+    int i, n;
+
+    /* ci_invalid must be glyph 0 */
+    if (ranges[0].ci != ci_invalid) {
+        fprintf(stderr, F("ci_invalid must be the first range\n"));
+        exit(EXIT_FAILURE);
+    } /* if */
+
+    /* measure the glyphs */
+    for (r = ranges; r->ci; r++) {
+        wchar_t c;
+        for (i = 0, c = r->fst; c <= r->lst; i++, c++) {
+            int j;
+
+            for (j = 0; r->ci[i].s[j]; j++) {
+                int n = strlen(r->ci[i].s[j]);
+                if (r->ci[i].w < n) r->ci[i].w = n;
+            } /* for */
+            if (max_width < r->ci[i].w)
+                max_width = r->ci[i].w;
+            r->ci[i].h = j;
+            if (r->ci[i].w > BM_MAXW || r->ci[i].h > 255) {
+                fprintf(stderr,
+                        F("glyph 0x%04x: too large (%zux%zu)\n"),
+                        (unsigned) c, r->ci[i].w, r->ci[i].h);
+                exit(EXIT_FAILURE);
+            } /* if */
+
+            /* the ink is the first non blank character found */
+            r->ci[i].ink = '#';
+            for (j = 0; r->ci[i].s[j]; j++) {
+                const char *s = r->ci[i].s[j]
+                        + strspn(r->ci[i].s[j], " ");
+                if (*s) {
+                    r->ci[i].ink = *s;
+                    break;
+                } /* if */
+            } /* for */
+            r->ci[i].off = n_rows;
+            n_rows += r->ci[i].h;
+            r->ci[i].num = n_glyphs++;
+        } /* for */
+    } /* for */
+    if (n_glyphs > 0xffff) {
+        fprintf(stderr, F("too many glyphs (%zu)\n"), n_glyphs);
+        exit(EXIT_FAILURE);
+    } /* if */
+
+    /* build the index */
+    if (new_page() != IDX_NONE || new_page() != IDX_HOT) {
+        fprintf(stderr, F("unexpected page numbering\n"));
+        exit(EXIT_FAILURE);
+    } /* if */
+    dir[0] = IDX_HOT;
+    for (r = ranges; r->ci; r++) {
+        wchar_t c;
+        for (c = r->fst; c <= r->lst; c++) {
+            int *pg = &dir[c >> IDX_BITS];
+            if (*pg == IDX_NONE)
+                *pg = new_page();
+            pages[*pg].num[c & IDX_MASK] = r->ci[c - r->fst].num;
+        } /* for */
+    } /* for */
+
+    printf("/* font.c --- constant font tables for sysvbanner.\n"
+           " * This file has been generated by mkfont from glyphs.h,\n"
+           " * DON'T EDIT.\n"
+           " */\n\n"
+           "#include \"font.h\"\n");
+
+    /* the glyphs */
+    printf("\nconst bm_row bitmaps[] = {\n");
+    for (r = ranges; r->ci; r++) {
+        wchar_t c;
+        for (i = 0, c = r->fst; c <= r->lst; i++, c++) {
+            int j;
+
+            if (!r->ci[i].h) continue;
+            printf("    /* 0x%04x */", (unsigned) c);
+            for (j = 0; r->ci[i].s[j]; j++) {
+                printf(" 0x%02x,",
+                    (unsigned) pack_row(&r->ci[i], c, r->ci[i].s[j]));
+            } /* for */
+            printf("\n");
+        } /* for */
+    } /* for */
+    printf("};\n");
+
+    /* the glyph info table, all the ranges one after the other */
+    printf("\nconst struct chrinfo glyphs[] = {\n");
+    for (r = ranges; r->ci; r++) {
+        wchar_t c;
+        for (i = 0, c = r->fst; c <= r->lst; i++, c++) {
+            printf("    /* %4zu: 0x%04x */ { %zu, %zu, '%s%c', 0, %zu },\n",
+                    r->ci[i].num, (unsigned) c, r->ci[i].w, r->ci[i].h,
+                    r->ci[i].ink == '\'' || r->ci[i].ink == '\\'
+                        ? "\\" : "",
+                    r->ci[i].ink, r->ci[i].off);
+        } /* for */
+    } /* for */
+    printf("};\n");
+
+    printf("\nconst struct range ranges[] = {\n");
+    for (r = ranges; r->ci; r++) {
+        printf("    { 0x%04x, 0x%04x, %zu },\n",
+                (unsigned) r->fst, (unsigned) r->lst, r->ci[0].num);
+    } /* for */
+    printf("};\n");
+    printf("\nconst int nranges = %d;\n", (int) (r - ranges));
+    printf("const int nglyphs = %zu;\n", n_glyphs);
+
+    printf("\nconst int max_width = %d;\n", max_width);
+
+    /* the index */
+    printf("\nconst unsigned short idx_page[][IDX_PGSZ] = {\n");
+    for (n = 0; n < n_pages; n++) {
+        printf("    { /* page %d */", n);
+        for (i = 0; i < IDX_PGSZ; i++)
+            printf(i % 16 ? " %d," : "\n        %d,", pages[n].num[i]);
+        printf("\n    },\n");
+    } /* for */
+    printf("};\n");
+
+    printf("\nconst unsigned short idx_dir[IDX_NPAGES] = {");
+    for (i = 0; i < IDX_NPAGES; i++) {
+        printf(i % 16 ? " %d," : "\n    %d,", dir[i]);
+    } /* for */
+    printf("\n};\n");
+
+    return EXIT_SUCCESS;
+} /* main */
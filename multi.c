@@ -0,0 +1,415 @@
+/* multi.c --- rendering of many files in parallel.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 10:05:17 EEST 2026
+ *
+ * sysvbanner -a -j N renders the files given as arguments with N
+ * threads, a whole file each.  The files are memory mapped (or read
+ * at once, if they can't be mapped) and their lines are rendered in
+ * place, with no copies.  The banners are written to the standard
+ * output in argument order, as they would have been without -j, or
+ * each to a file of the same name in the directory given with -o
+ * (so two files of the same name, in different directories, can't
+ * be rendered there together).
+ *
+ * For the output to stdout, only a window of files after the one
+ * being written can be rendered ahead, so memory use is bounded by
+ * the size of the banners of the files in the window.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "banner.h"
+
+#define MF_WINDOW       2       /* files rendered ahead, per thread */
+#define MF_FLUSH        (64 * 1024) /* output buffered for -o */
+
+struct buffer {
+    char   *b;
+    size_t  len, cap;
+};
+
+/* a file being rendered */
+struct file {
+    const char     *name;
+    struct buffer   out;
+    ssize_t         sep;        /* offset of the separator of the
+                                 * first unframed line, or -1 */
+    int             done;
+    int             err;        /* errno of the failure, or 0 */
+    const char     *what;       /* what failed */
+};
+
+static struct file     *mf_files;
+static int              mf_nfiles;
+static const char      *mf_outdir;
+static int              mf_next;        /* next file to render */
+static int              mf_written;     /* files written to stdout */
+static int              mf_window;
+static pthread_mutex_t  mf_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   mf_cond = PTHREAD_COND_INITIALIZER;
+
+static int
+buf_add(
+        struct buffer *b,
+        const char *s,
+        size_t n)
+{
+    if (b->len + n > b->cap) {
+        size_t cap = b->cap ? b->cap : BUFSIZ;
+        char *p;
+        while (cap < b->len + n) cap <<= 1;
+        p = realloc(b->b, cap);
+        if (!p) return -1;
+        b->b = p;
+        b->cap = cap;
+    } /* if */
+    memcpy(b->b + b->len, s, n);
+    b->len += n;
+    return 0;
+} /* buf_add */
+
+/* with -o, the output goes to its file in chunks */
+struct file_sink {
+    struct buffer  *buf;
+    int             fd;         /* -1 to keep it all in buf */
+};
+
+static int
+file_sink(
+        void *arg,
+        const char *s,
+        size_t n)
+{
+    struct file_sink *fs = arg;
+
+    if (buf_add(fs->buf, s, n) < 0)
+        return -1;
+    if (fs->fd >= 0 && fs->buf->len >= MF_FLUSH) {
+        if (sb_sink_fd(&fs->fd, fs->buf->b, fs->buf->len) < 0)
+            return -1;
+        fs->buf->len = 0;
+    } /* if */
+    return 0;
+} /* file_sink */
+
+/* the contents of the file, mapped if possible.  *mapped tells how
+ * to release them. */
+static char *
+load(
+        const char *name,
+        size_t *len,
+        int *mapped)
+{
+    struct stat st;
+    char *p = NULL;
+    size_t cap = 0;
+    int fd = open(name, O_RDONLY);
+
+    *len = 0;
+    *mapped = 0;
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        *len = st.st_size;
+        if (*len == 0) {
+            close(fd);
+            return "";
+        } /* if */
+        p = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            *mapped = 1;
+            madvise(p, *len, MADV_SEQUENTIAL);
+            close(fd);
+            return p;
+        } /* if */
+        p = NULL;
+        *len = 0;
+    } /* if */
+
+    /* not mappable (a pipe, a device), read it all */
+    for (;;) {
+        ssize_t n;
+        if (*len == cap) {
+            char *q = realloc(p, cap = cap ? 2 * cap : 65536);
+            if (!q) break;
+            p = q;
+        } /* if */
+        n = read(fd, p + *len, cap - *len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) break;
+        if (n == 0) {
+            close(fd);
+            if (*len) return p;
+            free(p);
+            return "";
+        } /* if */
+        *len += n;
+    } /* for */
+    free(p);
+    close(fd);
+    return NULL;
+} /* load */
+
+/* the last component of name, what it's called in the -o directory */
+static const char *
+base_name(
+        const char *name)
+{
+    const char *base = strrchr(name, '/');
+
+    return base ? base + 1 : name;
+} /* base_name */
+
+static int
+by_base_name(
+        const void *a,
+        const void *b)
+{
+    return strcmp(base_name(*(char *const *) a),
+            base_name(*(char *const *) b));
+} /* by_base_name */
+
+/* checks that no two files would be written to the same file of the
+ * -o directory */
+static int
+out_check(
+        char **names,
+        int nnames)
+{
+    char **sorted = malloc(nnames * sizeof *sorted);
+    int i, res = 0;
+
+    if (!sorted) {
+        fprintf(stderr,
+                F("malloc: %s (errno = %d)\n"),
+                strerror(errno), errno);
+        return -1;
+    } /* if */
+    memcpy(sorted, names, nnames * sizeof *sorted);
+    qsort(sorted, nnames, sizeof *sorted, by_base_name);
+    for (i = 1; i < nnames; i++) {
+        if (!by_base_name(&sorted[i - 1], &sorted[i])) {
+            fprintf(stderr,
+                    F("-o %s: %s and %s would both be written to %s/%s\n"),
+                    mf_outdir, sorted[i - 1], sorted[i],
+                    mf_outdir, base_name(sorted[i]));
+            res = -1;
+            break;
+        } /* if */
+    } /* for */
+    free(sorted);
+    return res;
+} /* out_check */
+
+static int
+out_open(
+        const char *name)
+{
+    char path[PATH_MAX];
+    const char *base = base_name(name);
+
+    if (snprintf(path, sizeof path, "%s/%s", mf_outdir, base)
+            >= (int) sizeof path) {
+        errno = ENAMETOOLONG;
+        return -1;
+    } /* if */
+    return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+} /* out_open */
+
+static void
+render(
+        struct sb_ctx *ctx,
+        struct file *f)
+{
+    struct file_sink fs = { &f->out, -1 };
+    const char *text, *p, *end;
+    size_t len;
+    int mapped;
+
+    if (!(text = load(f->name, &len, &mapped))) {
+        f->err = errno;
+        f->what = "fopen";
+        return;
+    } /* if */
+    if (mf_outdir && (fs.fd = out_open(f->name)) < 0) {
+        f->err = errno;
+        f->what = "open";
+        goto out;
+    } /* if */
+
+    /* the lines not framed (all of them, or those rendered empty with
+     * the frame closed) are separated from the lines before them by
+     * a newline, in this file or the previous ones, where a framed
+     * line starts with the frame.  Without -o, the first such
+     * separator is noted, the writer drops it if no file before this
+     * one had unframed lines. */
+    f->sep = -1;
+    if (mf_outdir)
+        sb_reset(ctx);
+    else
+        sb_resume(ctx);
+    for (p = text, end = text + len; p < end; ) {
+        const char *nl = memchr(p, '\n', end - p);
+        size_t n = nl ? nl - p : end - p, at = f->out.len;
+        if (sb_render_utf8(ctx, p, n, file_sink, &fs) < 0)
+            goto fail;
+        if (f->sep < 0 && fs.fd < 0 && f->out.len > at
+                && f->out.b[at] == '\n')
+            f->sep = at;
+        p += n + 1;
+    } /* for */
+    if (sb_close(ctx, file_sink, &fs) < 0
+            || (fs.fd >= 0 && f->out.len
+                && sb_sink_fd(&fs.fd, f->out.b, f->out.len) < 0))
+        goto fail;
+    goto out;
+
+fail:
+    f->err = errno;
+    f->what = mf_outdir ? "write" : "render";
+out:
+    if (mapped)
+        munmap((void *) text, len);
+    else if (len)
+        free((void *) text);
+    if (fs.fd >= 0) {
+        if (close(fs.fd) < 0 && !f->err) {
+            f->err = errno;
+            f->what = "close";
+        } /* if */
+        free(f->out.b);
+        f->out.b = NULL;
+    } /* if */
+} /* render */
+
+static void *
+mf_worker(
+        void *arg)
+{
+    struct sb_ctx *ctx = new_ctx(flags & FLAG_SB_MASK);
+    int i;
+
+    if (!ctx) {
+        fprintf(stderr,
+                F("sb_new: %s (errno = %d)\n"),
+                strerror(errno), errno);
+        exit(EXIT_FAILURE);
+    } /* if */
+    for (;;) {
+        pthread_mutex_lock(&mf_lock);
+        while (mf_next < mf_nfiles && !mf_outdir
+                && mf_next >= mf_written + mf_window)
+            pthread_cond_wait(&mf_cond, &mf_lock);
+        i = mf_next++;
+        pthread_mutex_unlock(&mf_lock);
+        if (i >= mf_nfiles)
+            break;
+
+        render(ctx, &mf_files[i]);
+
+        pthread_mutex_lock(&mf_lock);
+        mf_files[i].done = 1;
+        pthread_cond_broadcast(&mf_cond);
+        pthread_mutex_unlock(&mf_lock);
+    } /* for */
+    free_ctx(ctx);
+    return NULL;
+} /* mf_worker */
+
+int
+run_files(
+        int nthreads,
+        char **names,
+        int nnames,
+        const char *outdir,
+        int fd)
+{
+    pthread_t *thr = calloc(nthreads, sizeof *thr);
+    int i, any = 0, res = EXIT_SUCCESS;
+
+    mf_files = calloc(nnames, sizeof *mf_files);
+    if (!thr || !mf_files) {
+        fprintf(stderr,
+                F("calloc: %s (errno = %d)\n"),
+                strerror(errno), errno);
+        return EXIT_FAILURE;
+    } /* if */
+    for (i = 0; i < nnames; i++)
+        mf_files[i].name = names[i];
+    mf_nfiles = nnames;
+    mf_outdir = outdir;
+    mf_window = nthreads * MF_WINDOW;
+    if (outdir && out_check(names, nnames) < 0)
+        return EXIT_FAILURE;
+
+    for (i = 0; i < nthreads; i++) {
+        if ((errno = pthread_create(&thr[i], NULL, mf_worker, NULL))) {
+            fprintf(stderr,
+                    F("pthread_create: %s (errno = %d)\n"),
+                    strerror(errno), errno);
+            exit(EXIT_FAILURE);
+        } /* if */
+    } /* for */
+
+    /* collect the files in order */
+    for (i = 0; i < nnames; i++) {
+        struct file *f = &mf_files[i];
+
+        pthread_mutex_lock(&mf_lock);
+        while (!f->done)
+            pthread_cond_wait(&mf_cond, &mf_lock);
+        pthread_mutex_unlock(&mf_lock);
+
+        if (f->err) {
+            fprintf(stderr,
+                    F("%s: %s: %s (errno = %d)\n"),
+                    f->what, f->name, strerror(f->err), f->err);
+            /* without -o, stop there, as the serial version does */
+            if (!outdir) exit(EXIT_FAILURE);
+            res = EXIT_FAILURE;
+        } else if (!outdir) {
+            const char *b = f->out.b;
+            size_t n = f->out.len;
+
+            if (f->sep >= 0 && !any) {
+                /* nothing to separate from, yet */
+                if (f->sep && sb_sink_fd(&fd, b, f->sep) < 0)
+                    f->err = errno;
+                b += f->sep + 1;
+                n -= f->sep + 1;
+            } /* if */
+            if (!f->err && n && sb_sink_fd(&fd, b, n) < 0)
+                f->err = errno;
+            if (f->err) {
+                fprintf(stderr,
+                        F("write: %s (errno = %d)\n"),
+                        strerror(f->err), f->err);
+                exit(EXIT_FAILURE);
+            } /* if */
+            any |= f->sep >= 0;
+            free(f->out.b);
+            f->out.b = NULL;
+        } /* if */
+
+        stats_poll();
+        pthread_mutex_lock(&mf_lock);
+        mf_written = i + 1;
+        pthread_cond_broadcast(&mf_cond);
+        pthread_mutex_unlock(&mf_lock);
+    } /* for */
+
+    for (i = 0; i < nthreads; i++)
+        pthread_join(thr[i], NULL);
+    free(thr);
+    free(mf_files);
+    return res;
+} /* run_files */
@@ -0,0 +1,577 @@
+/* pipeline.c --- multithreaded rendering of big inputs.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 09:12:40 EEST 2026
+ *
+ * sysvbanner -t N renders its input with a pipeline: a reader thread
+ * cuts the input in jobs of whole lines, N workers render the bodies
+ * of the lines of each job (sb_body()) and the main thread writes
+ * them, in order, drawing the frame lines between them (sb_join()),
+ * which is the only part that depends on the previous line.  The
+ * output is the same as without -t.
+ *
+ * The stages are connected with single producer, single consumer
+ * lock free rings.  A thread finding its ring empty (or full) spins
+ * a little and then sleeps on the ring's condition variable, which
+ * the other end signals only when it knows someone sleeps there, so
+ * an idle pipeline takes no CPU and a busy one takes no locks.  The
+ * reader hands the jobs to the workers round robin, each through its
+ * own ring, and the writer takes them back in the same order from
+ * the workers' output rings, so the order is kept without any
+ * sequence numbers.  The jobs written go back to the reader through
+ * another ring, so memory use is bounded by the number of jobs.
+ *
+ * A job is also handed out, as it is, when a read comes back short
+ * and no more input is ready, so the lines typed on a terminal (or
+ * written slowly to a pipe) are drawn at once, while a file or a
+ * busy pipe still fills whole jobs.
+ *
+ * A job is cut when its text or the estimate of its output (see
+ * sb_estimate()) gets too big, whichever comes first, as a few bytes
+ * of text can make megabytes of banner (with -s, e.g.).  A line
+ * whose output alone would be too big is not rendered by the
+ * workers, but by the writer, in its turn, straight to the output,
+ * in chunks (as without -t).
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "banner.h"
+
+#define PL_JOB_TEXT     (16 * 1024) /* input bytes per job */
+#define PL_READ         (16 * 1024) /* input bytes read at once */
+#define PL_JOB_OUT      (4 * 1024 * 1024)   /* output bytes per job,
+                                             * as estimated */
+#define PL_JOBS_PER_W   3           /* jobs in flight per worker */
+#define PL_SPINS        256         /* looks at a ring before sleeping */
+#define PL_CACHELINE    64
+
+struct buffer {
+    char   *b;
+    size_t  len, cap;
+};
+
+struct job {
+    struct buffer   text;       /* the lines, with their newlines */
+    size_t         *line;       /* line k is text[line[k]..line[k+1]) */
+    size_t        (*width)[2];  /* the widths of the lines rendered
+                                 * (first and last banner line) */
+    size_t         *body;       /* body k is out[body[k]..body[k+1]) */
+    char           *big;        /* line k is left to the writer */
+    size_t          nlines, lines_cap;
+    size_t          est;        /* output estimated, big lines apart */
+    struct buffer   out;        /* the bodies */
+    int             close;      /* end of a file, close the frame */
+    const char     *fail;       /* file that couldn't be opened */
+    int             fail_errno;
+};
+
+/* a single producer, single consumer ring of jobs.  head is only
+ * written by the producer and tail by the consumer, each in its own
+ * cache line.  sleepers counts the ends waiting on cond (at most
+ * one, as the ring can't be empty and full at once). */
+struct ring {
+    _Alignas(PL_CACHELINE) atomic_size_t head;
+    _Alignas(PL_CACHELINE) atomic_size_t tail;
+    _Alignas(PL_CACHELINE) size_t        mask;
+    struct job                         **slot;
+    atomic_int                           sleepers;
+    pthread_mutex_t                      lock;
+    pthread_cond_t                       cond;
+};
+
+struct worker {
+    pthread_t       thr;
+    struct ring     in, out;
+    struct sb_ctx  *ctx;
+};
+
+static struct worker   *workers;
+static int              nworkers;
+static struct ring      free_jobs;  /* from the writer to the reader */
+static char           **files;      /* NULL to read stdin */
+static int              nfiles;
+
+static int
+ring_init(
+        struct ring *r,
+        size_t n)
+{
+    size_t cap;
+
+    for (cap = 2; cap < n; cap <<= 1)
+        continue;
+    r->slot = calloc(cap, sizeof *r->slot);
+    if (!r->slot) return -1;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->sleepers, 0);
+    r->mask = cap - 1;
+    if ((errno = pthread_mutex_init(&r->lock, NULL)) != 0
+            || (errno = pthread_cond_init(&r->cond, NULL)) != 0)
+        return -1;
+    return 0;
+} /* ring_init */
+
+static void
+ring_destroy(
+        struct ring *r)
+{
+    free(r->slot);
+    pthread_mutex_destroy(&r->lock);
+    pthread_cond_destroy(&r->cond);
+} /* ring_destroy */
+
+/* the occupation of the ring, as seen by a waiting end */
+static size_t
+ring_used(
+        struct ring *r)
+{
+    return atomic_load(&r->head) - atomic_load(&r->tail);
+} /* ring_used */
+
+/* waits, spinning PL_SPINS times and then sleeping, until the ring
+ * is no longer empty (full false) or full (full true) */
+static void
+ring_wait(
+        struct ring *r,
+        int full)
+{
+    unsigned spins;
+
+    for (spins = 0; spins < PL_SPINS; spins++) {
+        if (full ? ring_used(r) <= r->mask : ring_used(r) > 0)
+            return;
+        sched_yield();
+    } /* for */
+    /* sleepers is raised before looking at the ring again, and the
+     * other end looks at sleepers after moving its index, so one of
+     * the two sees the other (all sequentially consistent) */
+    pthread_mutex_lock(&r->lock);
+    atomic_fetch_add(&r->sleepers, 1);
+    while (full ? ring_used(r) > r->mask : ring_used(r) == 0)
+        pthread_cond_wait(&r->cond, &r->lock);
+    atomic_fetch_sub(&r->sleepers, 1);
+    pthread_mutex_unlock(&r->lock);
+} /* ring_wait */
+
+/* wakes up the other end, if it sleeps */
+static void
+ring_wake(
+        struct ring *r)
+{
+    if (atomic_load(&r->sleepers) == 0)
+        return;
+    pthread_mutex_lock(&r->lock);
+    pthread_cond_signal(&r->cond);
+    pthread_mutex_unlock(&r->lock);
+} /* ring_wake */
+
+/* NULL jobs are passed too, they mark the end of the input */
+static void
+ring_put(
+        struct ring *r,
+        struct job *j)
+{
+    size_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+
+    if (h - atomic_load_explicit(&r->tail, memory_order_acquire)
+            > r->mask)
+        ring_wait(r, 1);
+    r->slot[h & r->mask] = j;
+    atomic_store(&r->head, h + 1);
+    ring_wake(r);
+} /* ring_put */
+
+static struct job *
+ring_get(
+        struct ring *r)
+{
+    size_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    struct job *j;
+
+    if (atomic_load_explicit(&r->head, memory_order_acquire) == t)
+        ring_wait(r, 0);
+    j = r->slot[t & r->mask];
+    atomic_store(&r->tail, t + 1);
+    ring_wake(r);
+    return j;
+} /* ring_get */
+
+static int
+buf_add(
+        struct buffer *b,
+        const char *s,
+        size_t n)
+{
+    if (b->len + n > b->cap) {
+        size_t cap = b->cap ? b->cap : BUFSIZ;
+        char *p;
+        while (cap < b->len + n) cap <<= 1;
+        p = realloc(b->b, cap);
+        if (!p) return -1;
+        b->b = p;
+        b->cap = cap;
+    } /* if */
+    memcpy(b->b + b->len, s, n);
+    b->len += n;
+    return 0;
+} /* buf_add */
+
+static int
+buf_sink(
+        void *arg,
+        const char *s,
+        size_t n)
+{
+    return buf_add(arg, s, n);
+} /* buf_sink */
+
+static void
+fail(
+        const char *what)
+{
+    fprintf(stderr,
+            F("%s: %s (errno = %d)\n"),
+            what, strerror(errno), errno);
+    exit(EXIT_FAILURE);
+} /* fail */
+
+/* makes room for one more line in the job */
+static void
+job_reserve(
+        struct job *j)
+{
+    if (j->nlines + 2 > j->lines_cap) {
+        size_t cap = j->lines_cap ? 2 * j->lines_cap : 256;
+        if (!(j->line = realloc(j->line, cap * sizeof *j->line))
+                || !(j->width = realloc(j->width, cap * sizeof *j->width))
+                || !(j->body = realloc(j->body, cap * sizeof *j->body))
+                || !(j->big = realloc(j->big, cap * sizeof *j->big)))
+            fail("realloc");
+        j->lines_cap = cap;
+    } /* if */
+} /* job_reserve */
+
+/* adds a line to the job, with the estimate of its output */
+static void
+job_add(
+        struct job *j,
+        const char *s,
+        size_t n,
+        size_t est)
+{
+    job_reserve(j);
+    if (buf_add(&j->text, s, n) < 0)
+        fail("realloc");
+    j->big[j->nlines] = est > PL_JOB_OUT;
+    if (!j->big[j->nlines])
+        j->est += est;
+    j->line[++j->nlines] = j->text.len;
+} /* job_add */
+
+/* the job is full */
+static int
+job_full(
+        const struct job *j)
+{
+    return j->text.len >= PL_JOB_TEXT || j->est >= PL_JOB_OUT;
+} /* job_full */
+
+/* the text of line k of the job, as proc_line() in banner.c takes
+ * it: without the newlines before it, and up to the next one */
+static const char *
+job_line(
+        const struct job *j,
+        size_t k,
+        size_t *lenp)
+{
+    const char *l = j->text.b + j->line[k], *nl;
+    size_t len = j->line[k + 1] - j->line[k];
+
+    while (len && *l == '\n') {
+        l++; len--;
+    } /* while */
+    if ((nl = memchr(l, '\n', len)) != NULL)
+        len = nl - l;
+    *lenp = len;
+    return l;
+} /* job_line */
+
+static struct job *
+job_get(void)
+{
+    struct job *j = ring_get(&free_jobs);
+
+    j->text.len = j->out.len = j->nlines = j->est = 0;
+    j->close = 0;
+    j->fail = NULL;
+    job_reserve(j);
+    j->line[0] = 0;
+    return j;
+} /* job_get */
+
+/* hands the job to the next worker, and takes a new one */
+static struct job *
+job_put(
+        struct job *j,
+        int *w)
+{
+    ring_put(&workers[*w].in, j);
+    *w = (*w + 1) % nworkers;
+    return job_get();
+} /* job_put */
+
+/* there's input ready to be read without waiting */
+static int
+input_ready(
+        int fd)
+{
+    struct pollfd p;
+
+    p.fd = fd;
+    p.events = POLLIN;
+    return poll(&p, 1, 0) != 0;
+} /* input_ready */
+
+static void *
+reader(
+        void *arg)
+{
+    struct sb_ctx *ctx = arg;   /* only for sb_estimate() */
+    struct buffer in = { 0 };   /* the line not complete yet */
+    int w = 0, i = 0;
+    struct job *j = job_get();
+    sigset_t usr1;
+
+    /* SIGUSR1 comes here, to interrupt the wait for input */
+    sigemptyset(&usr1);
+    sigaddset(&usr1, SIGUSR1);
+    pthread_sigmask(SIG_UNBLOCK, &usr1, NULL);
+
+    do {
+        int fd = 0;
+
+        if (files && (fd = open(files[i], O_RDONLY | O_CLOEXEC)) < 0) {
+            j->fail = files[i];
+            j->fail_errno = errno;
+            break;
+        } /* if */
+        in.len = 0;
+        for (;;) {
+            char *p, *q, *nl;
+            ssize_t n;
+
+            if (in.cap - in.len < PL_READ) {
+                size_t cap = in.cap ? in.cap : PL_READ;
+                while (cap - in.len < PL_READ) cap <<= 1;
+                if (!(p = realloc(in.b, cap)))
+                    fail("realloc");
+                in.b = p;
+                in.cap = cap;
+            } /* if */
+            n = read(fd, in.b + in.len, PL_READ);
+            if (n < 0 && errno == EINTR) {
+                stats_poll();
+                continue;
+            } /* if */
+            if (n < 0)
+                fail("read");
+            if (n == 0)
+                break;
+
+            /* the complete lines, with their newlines (what was kept
+             * has none, only the bytes read are looked at) */
+            for (p = in.b, q = in.b + in.len;
+                    (nl = memchr(q, '\n', in.b + in.len + n - q)) != NULL;
+                    p = q = nl + 1) {
+                job_add(j, p, nl + 1 - p, sb_estimate(ctx, nl + 1 - p));
+                if (job_full(j))
+                    j = job_put(j, &w);
+            } /* for */
+            in.len += n;
+            memmove(in.b, p, in.len -= p - in.b);
+
+            /* the input stops here, for now */
+            if (n < PL_READ && j->nlines && !input_ready(fd))
+                j = job_put(j, &w);
+        } /* for */
+        if (in.len) /* the last line, without newline */
+            job_add(j, in.b, in.len, sb_estimate(ctx, in.len));
+        if (files) close(fd);
+        j->close = 1;
+        ring_put(&workers[w].in, j);
+        w = (w + 1) % nworkers;
+        j = NULL;
+        if (files && i + 1 < nfiles)
+            j = job_get();
+    } while (files && ++i < nfiles);
+
+    if (j) { /* the failure */
+        ring_put(&workers[w].in, j);
+        w = (w + 1) % nworkers;
+    } /* if */
+    /* and the end, for all the workers */
+    for (i = 0; i < nworkers; i++) {
+        ring_put(&workers[w].in, NULL);
+        w = (w + 1) % nworkers;
+    } /* for */
+    free(in.b);
+    return NULL;
+} /* reader */
+
+static void *
+worker(
+        void *arg)
+{
+    struct worker *me = arg;
+    struct job *j;
+
+    while ((j = ring_get(&me->in)) != NULL) {
+        size_t k;
+        for (k = 0; k < j->nlines; k++) {
+            size_t len;
+            const char *l = job_line(j, k, &len);
+
+            j->body[k] = j->out.len;
+            if (j->big[k])
+                continue;
+            if (sb_body(me->ctx, l, len, j->width[k],
+                    buf_sink, &j->out) < 0)
+                fail("sb_body");
+        } /* for */
+        j->body[k] = j->out.len;
+        ring_put(&me->out, j);
+    } /* while */
+    ring_put(&me->out, NULL);
+    return NULL;
+} /* worker */
+
+/* the writer, in the calling thread */
+static void
+writer(
+        struct sb_ctx *ctx,
+        int fd)
+{
+    struct buffer out = { 0 };
+    int w = 0;
+    struct job *j;
+
+    while ((j = ring_get(&workers[w].out)) != NULL) {
+        size_t k;
+
+        w = (w + 1) % nworkers;
+        if (j->fail) {
+            errno = j->fail_errno;
+            fprintf(stderr,
+                    F("open: %s: %s (errno = %d)\n"),
+                    j->fail, strerror(errno), errno);
+            exit(EXIT_FAILURE);
+        } /* if */
+        out.len = 0;
+        for (k = 0; k < j->nlines; k++) {
+            if (j->big[k]) {
+                /* what's before it goes first */
+                size_t len;
+                const char *l = job_line(j, k, &len);
+
+                if (out.len && sb_sink_fd(&fd, out.b, out.len) < 0)
+                    fail("write");
+                out.len = 0;
+                if (sb_render_utf8(ctx, l, len, sb_sink_fd, &fd) < 0)
+                    fail("sb_render");
+                continue;
+            } /* if */
+            if (sb_join(ctx, j->width[k], buf_sink, &out) < 0
+                    || buf_add(&out, j->out.b + j->body[k],
+                        j->body[k + 1] - j->body[k]) < 0)
+                fail("sb_join");
+        } /* for */
+        if (j->close && sb_close(ctx, buf_sink, &out) < 0)
+            fail("sb_close");
+        if (out.len && sb_sink_fd(&fd, out.b, out.len) < 0)
+            fail("write");
+        ring_put(&free_jobs, j);
+        stats_poll();
+    } /* while */
+    free(out.b);
+} /* writer */
+
+int
+run_pipeline(
+        int nthreads,
+        char **names,
+        int nnames,
+        int fd)
+{
+    int i, njobs = nthreads * PL_JOBS_PER_W;
+    struct sb_ctx *ctx = new_ctx(flags & FLAG_SB_MASK),
+                  *rd_ctx = new_ctx(flags & FLAG_SB_MASK);
+    pthread_t rd;
+    sigset_t usr1;
+
+    if (!ctx || !rd_ctx || !(workers = calloc(nthreads, sizeof *workers))
+            || ring_init(&free_jobs, njobs) < 0)
+        fail("run_pipeline");
+    nworkers = nthreads;
+    files = names;
+    nfiles = nnames;
+
+    for (i = 0; i < njobs; i++) {
+        struct job *j = calloc(1, sizeof *j);
+        if (!j) fail("calloc");
+        ring_put(&free_jobs, j);
+    } /* for */
+    /* only the reader takes SIGUSR1 (see stats_start()), the others
+     * may be sleeping on a ring, where it interrupts nothing */
+    sigemptyset(&usr1);
+    sigaddset(&usr1, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &usr1, NULL);
+    for (i = 0; i < nworkers; i++) {
+        struct worker *w = &workers[i];
+        if (ring_init(&w->in, njobs + 1) < 0
+                || ring_init(&w->out, njobs + 1) < 0
+                || !(w->ctx = new_ctx(flags & FLAG_SB_MASK)))
+            fail("run_pipeline");
+        if ((errno = pthread_create(&w->thr, NULL, worker, w)) != 0)
+            fail("pthread_create");
+    } /* for */
+    if ((errno = pthread_create(&rd, NULL, reader, rd_ctx)) != 0)
+        fail("pthread_create");
+
+    writer(ctx, fd);
+
+    pthread_join(rd, NULL);
+    pthread_sigmask(SIG_UNBLOCK, &usr1, NULL);
+    for (i = 0; i < nworkers; i++) {
+        pthread_join(workers[i].thr, NULL);
+        free_ctx(workers[i].ctx);
+        ring_destroy(&workers[i].in);
+        ring_destroy(&workers[i].out);
+    } /* for */
+    /* all the jobs are back */
+    for (i = 0; i < njobs; i++) {
+        struct job *j = ring_get(&free_jobs);
+        free(j->text.b);
+        free(j->out.b);
+        free(j->line);
+        free(j->width);
+        free(j->body);
+        free(j->big);
+        free(j);
+    } /* for */
+    ring_destroy(&free_jobs);
+    free(workers);
+    free_ctx(rd_ctx);
+    free_ctx(ctx);
+    return EXIT_SUCCESS;
+} /* run_pipeline */
@@ -0,0 +1,426 @@
+/* repaint.c --- differential repainting of banners in place.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 07:15:32 EEST 2026
+ *
+ * A screen keeps the last frame painted on the terminal.  The next
+ * frame is rendered into it (with rp_sink() and rp_mark()) and
+ * rp_paint() compares both, glyph cell by glyph cell, and only
+ * rewrites the cells that changed, moving the cursor with escape
+ * sequences.  Frame lines, and rows whose layout changed, are
+ * rewritten whole; if the number of rows changes, the frame is
+ * repainted completely.  Colored output is supported: what is
+ * rewritten is preceded by the color in effect at that point.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "banner.h"
+#include "repaint.h"
+
+struct rp_row {
+    size_t  off, len;       /* the row in the frame text, no '\n' */
+    size_t  bnd;            /* cell boundaries at bnd[bnd...] and
+                             * col[bnd...] */
+    size_t  ncells;         /* 0 if the row has no cells */
+};
+
+struct rp_frame {
+    char           *b;      /* the frame text */
+    size_t          len, cap;
+    size_t          scanned;    /* text already split in rows */
+    struct rp_row  *rows;
+    size_t          nrows, rows_cap;
+    size_t         *bnd;    /* byte offsets (in the row) of cells */
+    size_t         *col;    /* display columns of the same */
+    size_t          nbnd, bnd_cap, col_cap;
+    int             colored;    /* the text has escape sequences */
+};
+
+struct rp_screen {
+    struct rp_frame frm[2];
+    int             cur;        /* frame being rendered */
+    int             painted;    /* the other frame is on screen */
+    int             clear;      /* the screen has to be cleared */
+    struct rp_frame esc;        /* output being built */
+};
+
+static int
+grow(
+        void **p,
+        size_t *cap,
+        size_t need,
+        size_t sz)
+{
+    size_t n;
+    void *q;
+
+    if (need <= *cap)
+        return 0;
+    for (n = *cap ? *cap : 64; n < need; n <<= 1)
+        continue;
+    q = realloc(*p, n * sz);
+    if (!q) return -1;
+    *p = q;
+    *cap = n;
+    return 0;
+} /* grow */
+
+static int
+add(
+        struct rp_frame *f,
+        const char *s,
+        size_t n)
+{
+    if (grow((void **) &f->b, &f->cap, f->len + n, 1) < 0)
+        return -1;
+    memcpy(f->b + f->len, s, n);
+    f->len += n;
+    return 0;
+} /* add */
+
+static int
+addf(
+        struct rp_frame *f,
+        const char *fmt,
+        size_t n)
+{
+    char buf[32];
+
+    snprintf(buf, sizeof buf, fmt, n);
+    return add(f, buf, strlen(buf));
+} /* addf */
+
+/* splits in rows the text added since the last call */
+static int
+scan(
+        struct rp_frame *f)
+{
+    char *p = f->b + f->scanned, *end = f->b + f->len, *nl;
+
+    while ((nl = memchr(p, '\n', end - p)) != NULL) {
+        struct rp_row *r;
+        if (grow((void **) &f->rows, &f->rows_cap,
+                f->nrows + 1, sizeof *f->rows) < 0)
+            return -1;
+        r = &f->rows[f->nrows++];
+        r->off = p - f->b;
+        r->len = nl - p;
+        r->ncells = 0;
+        p = nl + 1;
+    } /* while */
+    f->scanned = p - f->b;
+    return 0;
+} /* scan */
+
+struct rp_screen *
+rp_new(void)
+{
+    return calloc(1, sizeof (struct rp_screen));
+} /* rp_new */
+
+void
+rp_free(
+        struct rp_screen *s)
+{
+    int i;
+
+    if (!s) return;
+    for (i = 0; i < 2; i++) {
+        free(s->frm[i].b);
+        free(s->frm[i].rows);
+        free(s->frm[i].bnd);
+        free(s->frm[i].col);
+    } /* for */
+    free(s->esc.b);
+    free(s);
+} /* rp_free */
+
+void
+rp_begin(
+        struct rp_screen *s)
+{
+    struct rp_frame *f = &s->frm[s->cur];
+
+    f->len = f->scanned = f->nrows = f->nbnd = 0;
+    f->colored = 0;
+} /* rp_begin */
+
+void
+rp_forget(
+        struct rp_screen *s)
+{
+    s->painted = 0;
+} /* rp_forget */
+
+void
+rp_resize(
+        struct rp_screen *s)
+{
+    s->painted = 0;
+    s->clear = 1;
+} /* rp_resize */
+
+int
+rp_sink(
+        void *arg,
+        const char *buf,
+        size_t len)
+{
+    struct rp_screen *s = arg;
+
+    if (memchr(buf, '\033', len))
+        s->frm[s->cur].colored = 1;
+    return add(&s->frm[s->cur], buf, len);
+} /* rp_sink */
+
+int
+rp_mark(
+        struct rp_screen *s,
+        struct sb_ctx *ctx)
+{
+    struct rp_frame *f = &s->frm[s->cur];
+    struct sb_geom g;
+    size_t i, j;
+
+    if (scan(f) < 0 || sb_geometry(ctx, &g) < 0)
+        return -1;
+    if (!g.ncells || g.rows > f->nrows)
+        return 0;
+
+    for (i = f->nrows - g.rows; i < f->nrows; i++) {
+        struct rp_row *r = &f->rows[i];
+        const char *p = f->b + r->off;
+        size_t k = 0, c = 0;
+
+        if (grow((void **) &f->bnd, &f->bnd_cap,
+                f->nbnd + g.ncells + 1, sizeof *f->bnd) < 0
+                || grow((void **) &f->col, &f->col_cap,
+                    f->nbnd + g.ncells + 1, sizeof *f->col) < 0)
+            return -1;
+
+        /* find the byte offset of each boundary, skipping escape
+         * sequences and multibyte characters.  A boundary goes
+         * before the escapes that precede its column, so a cell
+         * includes the color changes of its own ink. */
+        for (j = 0; j <= g.ncells; ) {
+            if (c == g.col[j]) {
+                f->bnd[f->nbnd + j] = k;
+                f->col[f->nbnd + j] = c;
+                j++;
+                continue;
+            } /* if */
+            if (k >= r->len)
+                break;
+            if (p[k] == '\033') {
+                while (++k < r->len && !(p[k] >= 0x40 && p[k] <= 0x7e
+                        && p[k] != '['))
+                    continue;
+                k++;
+                continue;
+            } /* if */
+            do k++;
+            while (k < r->len && (p[k] & 0xc0) == 0x80);
+            c++;
+        } /* for */
+        if (j <= g.ncells)
+            continue; /* not the layout expected, leave it alone */
+        r->bnd = f->nbnd;
+        r->ncells = g.ncells;
+        f->nbnd += g.ncells + 1;
+    } /* for */
+    return 0;
+} /* rp_mark */
+
+/* the escape sequence in effect at offset off of the text, or NULL
+ * if none */
+static const char *
+sgr_at(
+        const struct rp_frame *f,
+        size_t off,
+        size_t *len)
+{
+    const char *p = f->b + off, *end;
+
+    if (!f->colored)
+        return NULL;
+    while (p > f->b && *--p != '\033')
+        continue;
+    if (*p != '\033')
+        return NULL;
+    end = memchr(p, 'm', f->b + f->len - p);
+    *len = end ? end - p + 1 : 0;
+    return p;
+} /* sgr_at */
+
+/* adds the color in effect at offset off of frame f, so the text
+ * following is drawn with the right color */
+static int
+add_sgr(
+        struct rp_frame *e,
+        const struct rp_frame *f,
+        size_t off)
+{
+    size_t n;
+    const char *p = sgr_at(f, off, &n);
+
+    if (!f->colored)
+        return 0;
+    return p ? add(e, p, n) : add(e, "\033[m", 3);
+} /* add_sgr */
+
+/* true if the cell j of rows ra and rb look the same */
+static int
+same_cell(
+        const struct rp_frame *a, const struct rp_row *ra,
+        const struct rp_frame *b, const struct rp_row *rb,
+        size_t j)
+{
+    const size_t *ba = a->bnd + ra->bnd, *bb = b->bnd + rb->bnd;
+    size_t la = ba[j + 1] - ba[j], lb = bb[j + 1] - bb[j];
+    const char *sa, *sb;
+    size_t na = 0, nb = 0;
+
+    if (la != lb || memcmp(a->b + ra->off + ba[j], b->b + rb->off + bb[j], la))
+        return 0;
+    sa = sgr_at(a, ra->off + ba[j], &na);
+    sb = sgr_at(b, rb->off + bb[j], &nb);
+    return na == nb && (!na || !memcmp(sa, sb, na));
+} /* same_cell */
+
+/* moves the cursor from row *at to row r, column c */
+static int
+move(
+        struct rp_frame *e,
+        size_t *at,
+        size_t r,
+        size_t c)
+{
+    if (*at > r && addf(e, "\033[%zuA", *at - r) < 0)
+        return -1;
+    if (*at < r && addf(e, "\033[%zuB", r - *at) < 0)
+        return -1;
+    *at = r;
+    return addf(e, "\033[%zuG", c + 1);
+} /* move */
+
+/* true if both rows have the same cells, so they can be compared
+ * cell by cell */
+static int
+same_layout(
+        const struct rp_frame *a, const struct rp_row *ra,
+        const struct rp_frame *b, const struct rp_row *rb)
+{
+    const char *ta = a->b + ra->off, *tb = b->b + rb->off;
+    const size_t *ba = a->bnd + ra->bnd, *bb = b->bnd + rb->bnd;
+    size_t n = ra->ncells;
+
+    if (!n || n != rb->ncells
+            || memcmp(a->col + ra->bnd, b->col + rb->bnd,
+                (n + 1) * sizeof *a->col))
+        return 0;
+    /* and the same frame on both sides */
+    return ba[0] == bb[0]
+        && ra->len - ba[n] == rb->len - bb[n]
+        && !memcmp(ta, tb, ba[0])
+        && !memcmp(ta + ba[n], tb + bb[n], ra->len - ba[n]);
+} /* same_layout */
+
+static int
+paint_full(
+        struct rp_screen *s,
+        size_t old_rows)
+{
+    struct rp_frame *f = &s->frm[s->cur], *e = &s->esc;
+    size_t i;
+
+    /* after a resize, the terminal may have rewrapped the old rows,
+     * there's no telling where they are now */
+    if (s->clear) {
+        if (add(e, "\033[H\033[J", 6) < 0)
+            return -1;
+        s->clear = 0;
+    } else if (old_rows && addf(e, "\033[%zuA", old_rows) < 0)
+        return -1;
+    for (i = 0; i < f->nrows; i++) {
+        if (add(e, f->b + f->rows[i].off, f->rows[i].len) < 0
+                || add(e, "\033[K\n", 4) < 0)
+            return -1;
+    } /* for */
+    return add(e, "\033[J", 3);
+} /* paint_full */
+
+static int
+paint_diff(
+        struct rp_screen *s)
+{
+    struct rp_frame *f = &s->frm[s->cur], *o = &s->frm[!s->cur];
+    struct rp_frame *e = &s->esc;
+    size_t i, j, at = f->nrows;
+
+    for (i = 0; i < f->nrows; i++) {
+        struct rp_row *rn = &f->rows[i], *ro = &o->rows[i];
+        const char *tn = f->b + rn->off, *to = o->b + ro->off;
+
+        if (same_layout(f, rn, o, ro)) {
+            const size_t *bn = f->bnd + rn->bnd, *cn = f->col + rn->bnd;
+            for (j = 0; j < rn->ncells; ) {
+                size_t k;
+                if (same_cell(f, rn, o, ro, j)) {
+                    j++;
+                    continue;
+                } /* if */
+                /* a run of changed cells, rewritten at once */
+                for (k = j + 1; k < rn->ncells
+                        && !same_cell(f, rn, o, ro, k); k++)
+                    continue;
+                if (move(e, &at, i, cn[j]) < 0
+                        || add_sgr(e, f, rn->off + bn[j]) < 0
+                        || add(e, tn + bn[j], bn[k] - bn[j]) < 0)
+                    return -1;
+                j = k;
+            } /* for */
+        } else if (rn->len != ro->len || memcmp(tn, to, rn->len)) {
+            if (move(e, &at, i, 0) < 0
+                    || add_sgr(e, f, rn->off) < 0
+                    || add(e, tn, rn->len) < 0
+                    || add(e, "\033[K", 3) < 0)
+                return -1;
+        } /* if */
+    } /* for */
+
+    /* back to the bottom of the frame */
+    if (f->colored && e->len && add(e, "\033[m", 3) < 0)
+        return -1;
+    if (at < f->nrows
+            && (addf(e, "\033[%zuB", f->nrows - at) < 0
+                || add(e, "\r", 1) < 0))
+        return -1;
+    return 0;
+} /* paint_diff */
+
+int
+rp_paint(
+        struct rp_screen *s,
+        int fd)
+{
+    struct rp_frame *o = &s->frm[!s->cur];
+    int res;
+
+    if (scan(&s->frm[s->cur]) < 0)
+        return -1;
+    s->esc.len = 0;
+    res = s->painted && o->nrows == s->frm[s->cur].nrows
+        ? paint_diff(s)
+        : paint_full(s, s->painted ? o->nrows : 0);
+    if (res < 0
+            || (s->esc.len && sb_sink_fd(&fd, s->esc.b, s->esc.len) < 0))
+        return -1;
+
+    /* the new frame is now on the screen */
+    s->cur = !s->cur;
+    s->painted = 1;
+    return 0;
+} /* rp_paint */
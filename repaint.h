@@ -0,0 +1,32 @@
+/* repaint.h --- differential repainting of banners in place.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 07:15:32 EEST 2026
+ *
+ * Usage: rp_begin(), then for each line rendered with rp_sink() as
+ * the sink, rp_mark() with the same context, and finally
+ * rp_paint() to update the terminal.
+ */
+#ifndef _REPAINT_H
+#define _REPAINT_H
+
+#include "sysvbanner.h"
+
+struct rp_screen;
+
+struct rp_screen *rp_new(void);
+void rp_free(struct rp_screen *s);
+
+/* starts a new frame */
+void rp_begin(struct rp_screen *s);
+/* sink adding to the frame being built, arg is the screen */
+int rp_sink(void *arg, const char *buf, size_t len);
+/* records where the glyphs of the line just rendered are */
+int rp_mark(struct rp_screen *s, struct sb_ctx *ctx);
+/* paints the frame, updating only what changed */
+int rp_paint(struct rp_screen *s, int fd);
+/* the screen contents are unknown, next paint will be complete */
+void rp_forget(struct rp_screen *s);
+/* the terminal was resized, next paint clears it and starts over */
+void rp_resize(struct rp_screen *s);
+
+#endif /* _REPAINT_H */
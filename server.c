@@ -0,0 +1,399 @@
+/* server.c --- render server over a unix domain socket.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 06:02:19 EEST 2026
+ *
+ * sysvbanner --serve PATH listens on the unix socket PATH and
+ * answers rendering requests, so clients don't pay the cost of
+ * starting a new process for each banner.  Each request is a single
+ * line:
+ *
+ *      OPTIONS SP TEXT LF
+ *
+ * where OPTIONS is a word starting with '-' and made of the letters
+ * f, m and u (as in the command line, "-" alone for none) and TEXT is
+ * the UTF-8 text to render.  The reply is
+ *
+ *      LENGTH LF BANNER        (LENGTH is the size of BANNER, in
+ *                               decimal)
+ * or
+ *      'E' SP MESSAGE LF       (if the request was wrong, or its
+ *                               banner would be bigger than
+ *                               SRV_MAX_REPLY)
+ *
+ * BANNER includes the closing frame, if one was requested.  The
+ * rest of the rendering (font, scale, width, fill and colors) is as
+ * given in the command line, for all the requests.  Many clients are
+ * served at once, multiplexed with epoll(7).
+ */
+
+#define _GNU_SOURCE     /* for accept4(2) */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "banner.h"
+
+#ifdef __linux__
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define SRV_MAX_EVENTS  64
+#define SRV_MAX_REQ     65536       /* longest request accepted */
+#define SRV_MAX_PENDING (1 << 20)   /* stop reading a client with
+                                     * this much output pending */
+#define SRV_MAX_REPLY   (4 << 20)   /* biggest banner rendered */
+
+struct buffer {
+    char   *b;
+    size_t  len, cap;
+};
+
+struct client {
+    int             fd;
+    struct buffer   in;
+    struct buffer   out;
+    size_t          out_off;    /* already sent from out */
+    int             eof;        /* close once out is sent */
+    int             waiting;    /* epoll events armed */
+};
+
+static int                  ep = -1;
+static volatile sig_atomic_t stop;
+static struct sb_ctx       *ctxs[FLAG_SB_MASK + 1];
+static struct buffer        rendered;
+
+static void
+on_signal(
+        int sig)
+{
+    stop = 1;
+} /* on_signal */
+
+static int
+buf_add(
+        struct buffer *b,
+        const char *s,
+        size_t n)
+{
+    if (b->len + n > b->cap) {
+        size_t cap = b->cap ? b->cap : BUFSIZ;
+        char *p;
+        while (cap < b->len + n) cap <<= 1;
+        p = realloc(b->b, cap);
+        if (!p) return -1;
+        b->b = p;
+        b->cap = cap;
+    } /* if */
+    memcpy(b->b + b->len, s, n);
+    b->len += n;
+    return 0;
+} /* buf_add */
+
+static int
+buf_sink(
+        void *arg,
+        const char *s,
+        size_t n)
+{
+    return buf_add(arg, s, n);
+} /* buf_sink */
+
+static void
+cl_close(
+        struct client *cl)
+{
+    epoll_ctl(ep, EPOLL_CTL_DEL, cl->fd, NULL);
+    close(cl->fd);
+    free(cl->in.b);
+    free(cl->out.b);
+    free(cl);
+} /* cl_close */
+
+static void
+cl_error(
+        struct client *cl,
+        const char *msg)
+{
+    if (buf_add(&cl->out, "E ", 2) < 0
+            || buf_add(&cl->out, msg, strlen(msg)) < 0
+            || buf_add(&cl->out, "\n", 1) < 0)
+        cl->eof = 1;
+} /* cl_error */
+
+/* renders one request, appending the reply to the client output */
+static void
+cl_request(
+        struct client *cl,
+        const char *req,
+        size_t len)
+{
+    const char *sp = memchr(req, ' ', len);
+    int fl = 0;
+    const char *p;
+    char hdr[32];
+
+    if (len && req[len - 1] == '\r') len--;
+    if (!sp || req[0] != '-') {
+        cl_error(cl, "bad request, expected OPTIONS SP TEXT");
+        return;
+    } /* if */
+    for (p = req + 1; p < sp; p++) {
+        switch (*p) {
+        case 'f': fl |= SB_FRAME; break;
+        case 'm': fl |= SB_MONOSP; break;
+        case 'u': fl |= SB_UTF; break;
+        default:
+            cl_error(cl, "bad option");
+            return;
+        } /* switch */
+    } /* for */
+
+    /* the text of the requests is UTF-8, whatever the locale */
+    if (!ctxs[fl] && (!(ctxs[fl] = new_ctx(fl))
+                || sb_set_encoding(ctxs[fl], SB_ENC_UTF8) < 0)) {
+        cl_error(cl, strerror(errno));
+        return;
+    } /* if */
+    sp++;
+    /* the banner is kept twice until sent, refuse the big ones before
+     * rendering them */
+    if (sb_estimate(ctxs[fl], req + len - sp) > SRV_MAX_REPLY) {
+        cl_error(cl, "reply too large");
+        return;
+    } /* if */
+    sb_reset(ctxs[fl]);
+    rendered.len = 0;
+    if (sb_render_utf8(ctxs[fl], sp, req + len - sp, buf_sink, &rendered) < 0
+            || sb_close(ctxs[fl], buf_sink, &rendered) < 0) {
+        cl_error(cl, strerror(errno));
+        return;
+    } /* if */
+    snprintf(hdr, sizeof hdr, "%zu\n", rendered.len);
+    if (buf_add(&cl->out, hdr, strlen(hdr)) < 0
+            || buf_add(&cl->out, rendered.b, rendered.len) < 0)
+        cl->eof = 1;
+} /* cl_request */
+
+/* sends as much pending output as possible.  Returns -1 if the
+ * client has been closed. */
+static int
+cl_flush(
+        struct client *cl)
+{
+    struct epoll_event ev;
+
+    while (cl->out_off < cl->out.len) {
+        ssize_t n = send(cl->fd, cl->out.b + cl->out_off,
+                cl->out.len - cl->out_off, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            cl_close(cl);
+            return -1;
+        } /* if */
+        cl->out_off += n;
+    } /* while */
+    if (cl->out_off == cl->out.len) {
+        cl->out.len = cl->out_off = 0;
+        if (cl->eof) {
+            cl_close(cl);
+            return -1;
+        } /* if */
+    } /* if */
+
+    /* wait for room to write if there's something pending, and stop
+     * reading if too much is pending */
+    int pending = cl->out.len > cl->out_off;
+    int waiting = pending
+        ? cl->out.len - cl->out_off > SRV_MAX_PENDING || cl->eof
+            ? EPOLLOUT
+            : EPOLLOUT | EPOLLIN
+        : EPOLLIN;
+    if (waiting != cl->waiting) {
+        ev.events = waiting;
+        ev.data.ptr = cl;
+        epoll_ctl(ep, EPOLL_CTL_MOD, cl->fd, &ev);
+        cl->waiting = waiting;
+    } /* if */
+    return 0;
+} /* cl_flush */
+
+static void
+cl_read(
+        struct client *cl)
+{
+    char buf[BUFSIZ];
+
+    for (;;) {
+        ssize_t n = read(cl->fd, buf, sizeof buf);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            cl_close(cl);
+            return;
+        } /* if */
+        if (n == 0) {
+            /* a last request may come without its newline */
+            if (cl->in.len && cl->in.len <= SRV_MAX_REQ)
+                cl_request(cl, cl->in.b, cl->in.len);
+            cl->in.len = 0;
+            cl->eof = 1;
+            break;
+        } /* if */
+        if (buf_add(&cl->in, buf, n) < 0) {
+            cl_close(cl);
+            return;
+        } /* if */
+
+        /* process the complete requests */
+        char *p = cl->in.b, *end = cl->in.b + cl->in.len, *nl;
+        while ((nl = memchr(p, '\n', end - p)) != NULL) {
+            cl_request(cl, p, nl - p);
+            p = nl + 1;
+        } /* while */
+        cl->in.len = end - p;
+        memmove(cl->in.b, p, cl->in.len);
+        if (cl->in.len > SRV_MAX_REQ) {
+            cl_error(cl, "request too long");
+            cl->eof = 1;
+            break;
+        } /* if */
+        if (cl->out.len - cl->out_off > SRV_MAX_PENDING)
+            break;
+    } /* for */
+    cl_flush(cl);
+} /* cl_read */
+
+static void
+srv_accept(
+        int lfd)
+{
+    for (;;) {
+        struct epoll_event ev;
+        struct client *cl;
+        int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                fprintf(stderr,
+                        F("accept: %s (errno = %d)\n"),
+                        strerror(errno), errno);
+            return;
+        } /* if */
+        cl = calloc(1, sizeof *cl);
+        if (!cl) {
+            close(fd);
+            continue;
+        } /* if */
+        cl->fd = fd;
+        cl->waiting = EPOLLIN;
+        ev.events = EPOLLIN;
+        ev.data.ptr = cl;
+        if (epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            free(cl);
+        } /* if */
+    } /* for */
+} /* srv_accept */
+
+int
+serve(
+        const char *path)
+{
+    struct sockaddr_un addr;
+    struct epoll_event ev, evs[SRV_MAX_EVENTS];
+    struct sigaction sa;
+    struct stat st;
+    int lfd, i;
+
+    if (strlen(path) >= sizeof addr.sun_path) {
+        fprintf(stderr, F("%s: socket path too long\n"), path);
+        return EXIT_FAILURE;
+    } /* if */
+    memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    /* remove a stale socket, but nothing else */
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path);
+
+    lfd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (lfd < 0
+            || bind(lfd, (struct sockaddr *) &addr, sizeof addr) < 0
+            || listen(lfd, SOMAXCONN) < 0) {
+        fprintf(stderr,
+                F("%s: %s (errno = %d)\n"),
+                path, strerror(errno), errno);
+        return EXIT_FAILURE;
+    } /* if */
+
+    ep = epoll_create1(EPOLL_CLOEXEC);
+    if (ep < 0) {
+        fprintf(stderr,
+                F("epoll_create1: %s (errno = %d)\n"),
+                strerror(errno), errno);
+        return EXIT_FAILURE;
+    } /* if */
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &ev);
+
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    while (!stop) {
+        int n = epoll_wait(ep, evs, SRV_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                stats_poll();
+                continue;
+            } /* if */
+            fprintf(stderr,
+                    F("epoll_wait: %s (errno = %d)\n"),
+                    strerror(errno), errno);
+            break;
+        } /* if */
+        for (i = 0; i < n; i++) {
+            struct client *cl = evs[i].data.ptr;
+            if (!cl) {
+                srv_accept(lfd);
+            } else if (evs[i].events & EPOLLIN) {
+                cl_read(cl);
+            } else if (evs[i].events & EPOLLOUT) {
+                cl_flush(cl);
+            } else { /* EPOLLERR | EPOLLHUP */
+                cl_close(cl);
+            } /* if */
+        } /* for */
+    } /* while */
+
+    close(lfd);
+    unlink(path);
+    for (i = 0; i <= FLAG_SB_MASK; i++)
+        free_ctx(ctxs[i]);
+    return stop ? EXIT_SUCCESS : EXIT_FAILURE;
+} /* serve */
+
+#else /* __linux__ */
+
+int
+serve(
+        const char *path)
+{
+    fprintf(stderr, F("--serve is only supported on linux\n"));
+    return EXIT_FAILURE;
+} /* serve */
+
+#endif /* __linux__ */
@@ -0,0 +1,193 @@
+/* stats.c --- rendering statistics of the program.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 13:05:48 EEST 2026
+ *
+ * With --stats, the contexts made with new_ctx() keep statistics
+ * (see sb_set_stats()).  Those of all the contexts, in all the
+ * threads, are added up and reported on the standard error at exit,
+ * and also on SIGUSR1, at once if waiting for input or after the
+ * line being rendered, as text or as a JSON object (--stats=json).
+ * The report taken while other threads are rendering is approximate,
+ * their counters keep changing while they're read.
+ */
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "banner.h"
+
+int stats_format = STATS_NONE;
+volatile sig_atomic_t stats_due;
+
+static struct sb_ctx  **live;       /* the contexts in use */
+static size_t           nlive, live_cap;
+static struct sb_stats  gone;       /* of the contexts freed */
+static pthread_mutex_t  lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+add(
+        struct sb_stats *t,
+        const struct sb_stats *s)
+{
+    int i;
+
+    t->lines += s->lines;
+    t->glyphs += s->glyphs;
+    for (i = 0; i < SB_NRANGES; i++)
+        t->range[i] += s->range[i];
+    t->invalid += s->invalid;
+    t->row_bytes += s->row_bytes;
+    t->frame_bytes += s->frame_bytes;
+    t->sinks += s->sinks;
+    t->t_decode += s->t_decode;
+    t->t_measure += s->t_measure;
+    t->t_compose += s->t_compose;
+    t->t_output += s->t_output;
+} /* add */
+
+void
+stats_add(
+        struct sb_ctx *ctx)
+{
+    pthread_mutex_lock(&lock);
+    if (nlive == live_cap) {
+        size_t cap = live_cap ? 2 * live_cap : 16;
+        struct sb_ctx **p = realloc(live, cap * sizeof *p);
+        if (!p) { /* it won't be counted */
+            pthread_mutex_unlock(&lock);
+            return;
+        } /* if */
+        live = p;
+        live_cap = cap;
+    } /* if */
+    live[nlive++] = ctx;
+    sb_set_stats(ctx, 1);
+    pthread_mutex_unlock(&lock);
+} /* stats_add */
+
+/* the context is going to be freed, its counts are kept */
+void
+stats_drop(
+        struct sb_ctx *ctx)
+{
+    struct sb_stats st;
+    size_t i;
+
+    pthread_mutex_lock(&lock);
+    for (i = 0; i < nlive; i++) {
+        if (live[i] == ctx) {
+            sb_get_stats(ctx, &st);
+            add(&gone, &st);
+            live[i] = live[--nlive];
+            break;
+        } /* if */
+    } /* for */
+    pthread_mutex_unlock(&lock);
+} /* stats_drop */
+
+static void
+report_text(
+        FILE *f,
+        const struct sb_stats *t)
+{
+    unsigned long fst, lst;
+    int i;
+
+    fprintf(f, "stats: %lu lines, %lu glyphs, %lu not in the font\n",
+            t->lines, t->glyphs, t->invalid);
+    fprintf(f, "stats: glyphs by range:");
+    for (i = 0; sb_range(i, &fst, &lst) == 0; i++)
+        fprintf(f, "%s U+%04lX-U+%04lX %lu",
+                i ? "," : "", fst, lst, t->range[i]);
+    fprintf(f, "\n");
+    fprintf(f, "stats: output %lu bytes of glyph rows, %lu of frame "
+            "lines, %lu sink calls, %lu writes\n",
+            t->row_bytes, t->frame_bytes, t->sinks, sb_writes());
+    fprintf(f, "stats: time decode %.3f ms, measure %.3f ms, "
+            "compose %.3f ms, output %.3f ms\n",
+            t->t_decode / 1e6, t->t_measure / 1e6,
+            t->t_compose / 1e6, t->t_output / 1e6);
+} /* report_text */
+
+static void
+report_json(
+        FILE *f,
+        const struct sb_stats *t)
+{
+    unsigned long fst, lst;
+    int i;
+
+    fprintf(f, "{\"lines\": %lu, \"glyphs\": %lu, \"invalid\": %lu, "
+            "\"ranges\": [", t->lines, t->glyphs, t->invalid);
+    for (i = 0; sb_range(i, &fst, &lst) == 0; i++)
+        fprintf(f, "%s{\"first\": %lu, \"last\": %lu, \"glyphs\": %lu}",
+                i ? ", " : "", fst, lst, t->range[i]);
+    fprintf(f, "], \"row_bytes\": %lu, \"frame_bytes\": %lu, "
+            "\"sinks\": %lu, \"writes\": %lu, ",
+            t->row_bytes, t->frame_bytes, t->sinks, sb_writes());
+    fprintf(f, "\"time_ns\": {\"decode\": %llu, \"measure\": %llu, "
+            "\"compose\": %llu, \"output\": %llu}}\n",
+            t->t_decode, t->t_measure, t->t_compose, t->t_output);
+} /* report_json */
+
+void
+stats_report(
+        FILE *f)
+{
+    struct sb_stats t, st;
+    size_t i;
+
+    pthread_mutex_lock(&lock);
+    t = gone;
+    for (i = 0; i < nlive; i++) {
+        sb_get_stats(live[i], &st);
+        add(&t, &st);
+    } /* for */
+    pthread_mutex_unlock(&lock);
+
+    if (stats_format == STATS_JSON)
+        report_json(f, &t);
+    else
+        report_text(f, &t);
+    fflush(f);
+} /* stats_report */
+
+/* the report requested with SIGUSR1, if any */
+void
+stats_poll(void)
+{
+    if (!stats_due)
+        return;
+    stats_due = 0;
+    stats_report(stderr);
+} /* stats_poll */
+
+static void
+on_usr1(
+        int sig)
+{
+    stats_due = 1;
+} /* on_usr1 */
+
+static void
+at_exit(void)
+{
+    stats_report(stderr);
+} /* at_exit */
+
+/* reports at exit, and on SIGUSR1 */
+void
+stats_start(void)
+{
+    struct sigaction sa;
+
+    /* without SA_RESTART, so a read waiting for input is interrupted
+     * and the report is printed at once (see stats_poll()) */
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = on_usr1;
+    sigaction(SIGUSR1, &sa, NULL);
+    atexit(at_exit);
+} /* stats_start */
@@ -0,0 +1,236 @@
+/* sysvbanner.h --- interface to the banner rendering library.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 05:31:07 EEST 2026
+ *
+ * All the rendering state lives in a struct sb_ctx, so several
+ * contexts can be used at the same time (one per thread, e.g.).
+ * Each call to sb_render() draws one line of text as one banner line
+ * and hands the result to a sink function, either as a single chunk
+ * or row by row (if the context has SB_ROWS set).
+ */
+#ifndef _SYSVBANNER_H
+#define _SYSVBANNER_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <wchar.h>
+
+/* context flags */
+#define SB_MONOSP   (1 << 0)    /* all glyphs have the same width */
+#define SB_FRAME    (1 << 1)    /* draw a frame around the text */
+#define SB_UTF      (1 << 2)    /* draw the frame with box characters */
+#define SB_ROWS     (1 << 3)    /* call the sink once per output row */
+#define SB_WRITEV   (1 << 4)    /* write the glyph rows with writev(2) */
+
+struct sb_ctx;
+
+/* a sink receives the rendered output.  It must return 0 on
+ * success or -1 (with errno set) to abort the rendering. */
+typedef int sb_sink(void *arg, const char *buf, size_t len);
+
+/* caller supplied buffer, to be used with sb_sink_mem().  At most
+ * size bytes are stored in buf, but len counts all the bytes
+ * produced (as snprintf(3) does), so truncation can be detected. */
+struct sb_mem {
+    char   *buf;
+    size_t  size;
+    size_t  len;
+};
+
+struct sb_ctx *sb_new(int flags);
+void sb_free(struct sb_ctx *ctx);
+int sb_flags(const struct sb_ctx *ctx);
+
+/* the encoding of the text given to sb_render_utf8() and sb_body().
+ * UTF-8 (the default) and Latin-1 are decoded by the library, any
+ * other encoding through the locale (LC_CTYPE must be set then). */
+#define SB_ENC_UTF8     0
+#define SB_ENC_LATIN1   1
+#define SB_ENC_LOCALE   2
+
+int sb_set_encoding(struct sb_ctx *ctx, int enc);
+
+/* render one line of text, len characters (or bytes for the UTF-8
+ * version) long.  Return the number of bytes sent to the sink or -1
+ * on error. */
+ssize_t sb_render(struct sb_ctx *ctx,
+        const wchar_t *s, size_t len,
+        sb_sink *sink, void *arg);
+ssize_t sb_render_utf8(struct sb_ctx *ctx,
+        const char *s, size_t len,
+        sb_sink *sink, void *arg);
+
+/* a line given in parts, len bytes of UTF-8 text (or in the encoding
+ * set) each, more telling whether the next call goes on with the
+ * same line.  So the caller doesn't have to hold a long line whole:
+ * with a width set (see sb_set_width()) each banner line is composed
+ * as soon as the text it's wrapped at is known, and the context only
+ * keeps the glyphs of the next one.  Without a width, the banner
+ * line is as wide as the text and its glyphs are kept until the last
+ * part.  The parts of a line are not kept for sb_relayout(). */
+ssize_t sb_render_part(struct sb_ctx *ctx,
+        const char *s, size_t len, int more,
+        sb_sink *sink, void *arg);
+
+/* the same in two steps, for callers rendering lines out of order
+ * (in several threads, e.g.): sb_body() renders the glyph rows of a
+ * line (the banner lines it's wrapped in, with what goes between
+ * them), keeping no state between lines, and stores the widths of
+ * its first and last banner lines in width[]; sb_join(), called in
+ * order on another context for each line, outputs what goes before
+ * it (frame lines, separators).  The output of sb_join() followed by
+ * that of sb_body() is what sb_render_utf8() would have output. */
+ssize_t sb_body(struct sb_ctx *ctx,
+        const char *s, size_t len, size_t width[2],
+        sb_sink *sink, void *arg);
+ssize_t sb_join(struct sb_ctx *ctx, const size_t width[2],
+        sb_sink *sink, void *arg);
+
+/* sb_join() followed by a body rendered before by sb_body() (on a
+ * context with the same settings) and kept by the caller, len bytes
+ * at body, for callers caching the bodies of repeated lines.  Both
+ * go to the sink at once (cut in rows with SB_ROWS), and with
+ * SB_WRITEV and sb_sink_fd() the body is not even copied, but
+ * written from where it's kept, by the same writev(2) as the join.
+ * Only the join is counted in the statistics of the context, the
+ * body was by the sb_body() that rendered it (see sb_add_stats()). */
+ssize_t sb_join_body(struct sb_ctx *ctx, const size_t width[2],
+        const char *body, size_t len,
+        sb_sink *sink, void *arg);
+
+/* wrapping: with a width set, each line of text is broken (at spaces
+ * if possible) into as many banner lines as needed to fit in cols
+ * columns, frame included.  0, the default, for no wrapping.
+ * sb_relayout() renders again the last line of text with the width
+ * now set, without decoding it again (after the terminal has been
+ * resized, e.g.). */
+void sb_set_width(struct sb_ctx *ctx, size_t cols);
+ssize_t sb_relayout(struct sb_ctx *ctx,
+        sb_sink *sink, void *arg);
+
+/* scaling: each glyph column is drawn sx columns wide (the gaps
+ * between glyphs too) and each glyph row sy rows high, the frame
+ * is not scaled.  1 and 1, the default, for the normal size.  The
+ * glyphs are scaled once, the first time they are drawn, and kept in
+ * the context (until the font, the style or the scale change). */
+int sb_set_scale(struct sb_ctx *ctx, int sx, int sy);
+
+/* close the frame (if any) after the last line rendered, so the
+ * next line starts a new one. */
+ssize_t sb_close(struct sb_ctx *ctx,
+        sb_sink *sink, void *arg);
+
+/* styling of the output.  The '#' ink of the glyphs can be replaced
+ * by another fill character, and ANSI colors can be used, given as
+ * SGR parameters ("32", "1;36", "38;5;202", ...).  The frame is drawn
+ * in the frame color and the ink depending on the color mode: all
+ * in the ink color (SB_COLOR_RUN), each glyph in the next color of
+ * the palette (SB_COLOR_GLYPH) or the palette spread from left to
+ * right over the columns (SB_COLOR_GRADIENT). */
+#define SB_COLOR_NONE       0
+#define SB_COLOR_RUN        1
+#define SB_COLOR_GLYPH      2
+#define SB_COLOR_GRADIENT   3
+
+struct sb_style {
+    int                 fill;       /* replaces '#', 0 to keep it */
+    int                 color;      /* one of SB_COLOR_* */
+    const char         *frame;      /* frame color, or NULL */
+    const char         *ink;        /* ink color for SB_COLOR_RUN */
+    const char *const  *palette;    /* for GLYPH and GRADIENT */
+    size_t              npalette;
+};
+
+/* the style is copied into the context */
+int sb_set_style(struct sb_ctx *ctx, const struct sb_style *st);
+
+/* geometry of the last line rendered, for callers that need to know
+ * where each glyph landed (to repaint only what changed, e.g.).
+ * If the line was wrapped, this is the last banner line.  It has rows
+ * glyph rows (the last rows output, the frame
+ * lines and separators come before them) and glyph j spans display
+ * columns col[j] to col[j + 1] - 1, the gap before it included.
+ * col has ncells + 1 entries and stays valid until the next call on
+ * the context. */
+struct sb_geom {
+    size_t          rows;
+    size_t          ncells;
+    const size_t   *col;
+};
+
+int sb_geometry(struct sb_ctx *ctx, struct sb_geom *g);
+
+/* forget the state kept between lines (frame and line count), so
+ * the context can be reused for an unrelated text.  Nothing is
+ * output, sb_close() should be called first if a frame is open. */
+void sb_reset(struct sb_ctx *ctx);
+
+/* the same, but as if some lines (with their frame closed) had been
+ * rendered before, so the next line is separated from them.  For
+ * callers splitting a text among several contexts. */
+void sb_resume(struct sb_ctx *ctx);
+
+/* statistics of the rendering, kept by a context once enabled with
+ * sb_set_stats(): what was rendered, what was output and the time
+ * (in nanoseconds) spent decoding the text, measuring and laying out
+ * the banner lines, composing their rows and frames, and in the sink.
+ * range[i] counts the glyphs looked up in the range i of the font
+ * (see sb_range()). */
+#define SB_NRANGES      8
+
+struct sb_stats {
+    unsigned long       lines;          /* of text */
+    unsigned long       glyphs;
+    unsigned long       range[SB_NRANGES];
+    unsigned long       invalid;        /* not in the font */
+    unsigned long       row_bytes;      /* glyph rows and separators */
+    unsigned long       frame_bytes;    /* frame lines */
+    unsigned long       sinks;          /* calls to the sink */
+    unsigned long long  t_decode, t_measure, t_compose, t_output;
+};
+
+void sb_set_stats(struct sb_ctx *ctx, int on);
+void sb_get_stats(const struct sb_ctx *ctx, struct sb_stats *st);
+
+/* adds st to the statistics of the context (if it keeps them), for
+ * the lines the caller outputs without rendering them again, as the
+ * bodies of sb_join_body(): st is then what their sb_body() added,
+ * as told by sb_get_stats() before and after it. */
+void sb_add_stats(struct sb_ctx *ctx, const struct sb_stats *st);
+
+/* the code points of range i of the font, -1 if there's no such
+ * range */
+int sb_range(int i, unsigned long *fst, unsigned long *lst);
+
+/* an estimate, from above, of the bytes output by sb_render_utf8()
+ * (or sb_join() and sb_body()) for a line of len bytes of text, with
+ * the font, scale, width and style set in the context.  For callers
+ * that must bound the memory taken by the lines they keep rendered. */
+size_t sb_estimate(const struct sb_ctx *ctx, size_t len);
+
+/* the write(2) calls made by sb_sink_fd(), for all the contexts */
+unsigned long sb_writes(void);
+
+/* FIGlet fonts.  sb_font_load() loads the .flf file path, compiled
+ * into the directory cache (if not NULL) the first time, and just
+ * mapped in memory from there the next ones.  It returns NULL with
+ * errno set on error (EINVAL if the file is not a FIGlet font).  A
+ * font can be shared by many contexts (in many threads), and must
+ * not be freed while they use it.  sb_set_font() sets the font of a
+ * context, NULL for the built-in one.  The glyphs of the fonts are
+ * drawn without gap between them. */
+struct sb_font;
+
+struct sb_font *sb_font_load(const char *path, const char *cache);
+void sb_font_free(struct sb_font *f);
+void sb_set_font(struct sb_ctx *ctx, const struct sb_font *f);
+
+/* predefined sinks, arg is a pointer to an int file descriptor or to
+ * a struct sb_mem.  With SB_WRITEV (and without SB_ROWS), the glyph
+ * rows without colors sent to sb_sink_fd() are not composed at all,
+ * but written with writev(2) pointing at the glyphs drawn in the
+ * context, so their bytes are not copied on the way out. */
+int sb_sink_fd(void *arg, const char *buf, size_t len);
+int sb_sink_mem(void *arg, const char *buf, size_t len);
+
+#endif /* _SYSVBANNER_H */
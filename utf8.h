@@ -0,0 +1,129 @@
+/* utf8.h --- built-in UTF-8 decoding.
+ * Author: Luis Colorado <luiscoloradourcola@gmail.com>
+ * Date: Sun Oct 18 11:48:05 EEST 2026
+ *
+ * The library decodes UTF-8 by itself, without going through the
+ * locale's mbrtowc(3).  Most input is plain ASCII, so utf8_ascii()
+ * first measures the run of ASCII bytes at the start of the text
+ * (sixteen or thirty two bytes at a time with SSE2 or AVX2, see
+ * bitmap.h for how they're selected), whose glyphs can be looked up
+ * directly by byte.  utf8_decode() decodes one character of the
+ * rest, following RFC 3629: overlong forms, surrogates and code
+ * points past U+10FFFF are invalid.  utf8_tail() finds a character
+ * cut at the end of a piece of text, for text decoded in parts.
+ */
+#ifndef _UTF8_H
+#define _UTF8_H
+
+#include <stddef.h>
+#include <wchar.h>
+
+#if !defined(BM_SCALAR) && defined(__AVX2__)
+#include <immintrin.h>
+#elif !defined(BM_SCALAR) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* what utf8_decode() returns for an invalid or truncated sequence */
+#define UTF8_INVALID    0xfffe
+
+/* length of the run of ASCII bytes at the start of s */
+static inline size_t
+utf8_ascii(
+        const char *s,
+        size_t len)
+{
+    size_t n = 0;
+
+#if !defined(BM_SCALAR) && defined(__AVX2__)
+    for (; n + 32 <= len; n += 32) {
+        unsigned m = _mm256_movemask_epi8(
+                _mm256_loadu_si256((const __m256i *) (s + n)));
+        if (m) return n + __builtin_ctz(m);
+    } /* for */
+#elif !defined(BM_SCALAR) && defined(__SSE2__)
+    for (; n + 16 <= len; n += 16) {
+        unsigned m = _mm_movemask_epi8(
+                _mm_loadu_si128((const __m128i *) (s + n)));
+        if (m) return n + __builtin_ctz(m);
+    } /* for */
+#endif
+    while (n < len && !(s[n] & 0x80))
+        n++;
+    return n;
+} /* utf8_ascii */
+
+/* decodes the character at s into *c, returning the bytes used.  An
+ * invalid sequence uses one byte and a truncated one at the end of
+ * the text all that's left, both give UTF8_INVALID. */
+static inline size_t
+utf8_decode(
+        const char *s,
+        size_t len,
+        wchar_t *c)
+{
+    const unsigned char *p = (const unsigned char *) s;
+    unsigned long v;
+    unsigned char lo = 0x80, hi = 0xbf;  /* valid second byte */
+    size_t i, n;
+
+    if (p[0] < 0x80) {
+        *c = p[0];
+        return 1;
+    } else if (p[0] < 0xc2) {   /* continuation, or overlong */
+        *c = UTF8_INVALID;
+        return 1;
+    } else if (p[0] < 0xe0) {
+        n = 2; v = p[0] & 0x1f;
+    } else if (p[0] < 0xf0) {
+        n = 3; v = p[0] & 0x0f;
+        if (p[0] == 0xe0) lo = 0xa0;        /* overlong */
+        if (p[0] == 0xed) hi = 0x9f;        /* surrogates */
+    } else if (p[0] < 0xf5) {
+        n = 4; v = p[0] & 0x07;
+        if (p[0] == 0xf0) lo = 0x90;        /* overlong */
+        if (p[0] == 0xf4) hi = 0x8f;        /* past U+10FFFF */
+    } else {
+        *c = UTF8_INVALID;
+        return 1;
+    } /* if */
+
+    for (i = 1; i < n; i++) {
+        if (i >= len) {             /* truncated */
+            *c = UTF8_INVALID;
+            return len;
+        } /* if */
+        if (p[i] < lo || p[i] > hi) {
+            *c = UTF8_INVALID;
+            return 1;
+        } /* if */
+        v = v << 6 | (p[i] & 0x3f);
+        lo = 0x80; hi = 0xbf;
+    } /* for */
+    *c = v;
+    return n;
+} /* utf8_decode */
+
+/* length of the sequence cut at the end of s (the bytes of a
+ * character that goes on after them), 0 if there's none */
+static inline size_t
+utf8_tail(
+        const char *s,
+        size_t len)
+{
+    const unsigned char *p = (const unsigned char *) s;
+    size_t i, n;
+
+    for (i = 1; i <= 3 && i <= len; i++) {
+        unsigned char c = p[len - i];
+        if (c < 0x80)
+            return 0;
+        if (c < 0xc0)           /* continuation, look further back */
+            continue;
+        n = c < 0xc2 ? 1 : c < 0xe0 ? 2 : c < 0xf0 ? 3 : c < 0xf5 ? 4 : 1;
+        return n > i ? i : 0;
+    } /* for */
+    return 0;
+} /* utf8_tail */
+
+#endif /* _UTF8_H */